@@ -0,0 +1,246 @@
+/*
+  ==============================================================================
+
+    EffectsChain.h
+    Created: 18 Oct 2026 2:58:44am
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+// Chorus, delay and reverb on the summed synth output, processed a whole block at a time.
+// Every buffer is allocated in prepare. Switching an effect on or off crossfades between its input and
+// its output over bypassFadeSeconds, and only once it has faded out is it skipped entirely, so it
+// costs nothing. It is cleared when it starts again so no stale audio comes back.
+class EffectsChain
+{
+public:
+	static constexpr double maxDelaySeconds = 2.0;
+	static constexpr double delaySmoothingSeconds = 0.05; // Time changes glide rather than click
+	static constexpr double bypassFadeSeconds = 0.05;
+	static constexpr int fadeChunkSize = 256;
+
+	void prepare(double sampleRate, int samplesPerBlock, int numChannels)
+	{
+		juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32>(juce::jmax(1, samplesPerBlock)),
+			static_cast<juce::uint32>(juce::jmax(1, numChannels)) };
+
+		chorus.prepare(spec);
+		reverb.prepare(spec);
+
+		delayLine.setMaximumDelayInSamples(static_cast<int>(std::ceil(maxDelaySeconds * sampleRate)) + 1);
+		delayLine.prepare(spec);
+		delaySamples.reset(sampleRate, delaySmoothingSeconds);
+
+		dryBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
+
+		for (auto* level : { &chorusLevel, &delayLevel, &reverbLevel })
+		{
+			level->reset(sampleRate, bypassFadeSeconds);
+			level->setCurrentAndTargetValue(0.0f);
+		}
+
+		currentSampleRate = sampleRate;
+	}
+
+	// Reads the effect parameters, call on the audio thread before process
+	void update(const ParameterSnapshot& parameters)
+	{
+		bool chorusEnabled = parameters.get(ParameterRegistry::chorusEnabled) >= 0.5f;
+		bool delayEnabled = parameters.get(ParameterRegistry::delayEnabled) >= 0.5f;
+		bool reverbEnabled = parameters.get(ParameterRegistry::reverbEnabled) >= 0.5f;
+
+		// A fading effect keeps its last settings until it is silent
+		if (chorusEnabled)
+		{
+			if (!isRunning(chorusLevel))
+				chorus.reset();
+
+			chorus.setRate(parameters.get(ParameterRegistry::chorusRate));
+			chorus.setDepth(parameters.get(ParameterRegistry::chorusDepth));
+			chorus.setMix(parameters.get(ParameterRegistry::chorusMix));
+		}
+
+		if (delayEnabled)
+		{
+			float time = static_cast<float>(parameters.get(ParameterRegistry::delayTime) * currentSampleRate);
+
+			if (!isRunning(delayLevel))
+			{
+				delayLine.reset();
+				delaySamples.setCurrentAndTargetValue(time);
+			}
+
+			delaySamples.setTargetValue(time);
+			delayFeedback = parameters.get(ParameterRegistry::delayFeedback);
+			delayMix = parameters.get(ParameterRegistry::delayMix);
+		}
+
+		if (reverbEnabled)
+		{
+			if (!isRunning(reverbLevel))
+				reverb.reset();
+
+			juce::dsp::Reverb::Parameters reverbParameters;
+			reverbParameters.roomSize = parameters.get(ParameterRegistry::reverbSize);
+			reverbParameters.damping = parameters.get(ParameterRegistry::reverbDamping);
+			reverbParameters.wetLevel = parameters.get(ParameterRegistry::reverbMix);
+			reverbParameters.dryLevel = 1.0f - reverbParameters.wetLevel;
+
+			// The reverb recalculates its filters on every call, so only pass it real changes
+			if (reverbParameters.roomSize != appliedReverbParameters.roomSize
+				|| reverbParameters.damping != appliedReverbParameters.damping
+				|| reverbParameters.wetLevel != appliedReverbParameters.wetLevel)
+			{
+				reverb.setParameters(reverbParameters);
+				appliedReverbParameters = reverbParameters;
+			}
+		}
+
+		chorusLevel.setTargetValue(chorusEnabled ? 1.0f : 0.0f);
+		delayLevel.setTargetValue(delayEnabled ? 1.0f : 0.0f);
+		reverbLevel.setTargetValue(reverbEnabled ? 1.0f : 0.0f);
+	}
+
+	bool isActive() const
+	{
+		return isRunning(chorusLevel) || isRunning(delayLevel) || isRunning(reverbLevel);
+	}
+
+	void process(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples)
+	{
+		if (!isActive())
+			return;
+
+		juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), static_cast<size_t>(numChannels),
+			static_cast<size_t>(numSamples));
+		juce::dsp::ProcessContextReplacing<float> context(block);
+
+		if (isRunning(chorusLevel))
+			processFaded(buffer, numChannels, numSamples, chorusLevel, [&] { chorus.process(context); });
+
+		if (isRunning(delayLevel))
+			processFaded(buffer, numChannels, numSamples, delayLevel, [&] { processDelay(context); });
+
+		if (isRunning(reverbLevel))
+			processFaded(buffer, numChannels, numSamples, reverbLevel, [&] { reverb.process(context); });
+	}
+
+	// How long the effects ring on after their input stops, for the host's tail length
+	static double getTailLengthSeconds(const ParameterSnapshot& parameters)
+	{
+		double tail = 0.0;
+
+		// Echoes until the feedback has brought them down 60 dB
+		if (parameters.get(ParameterRegistry::delayEnabled) >= 0.5f)
+		{
+			double time = parameters.get(ParameterRegistry::delayTime);
+			double feedback = parameters.get(ParameterRegistry::delayFeedback);
+			tail += feedback > 0.001 ? time * (1.0 + std::log(0.001) / std::log(feedback)) : time;
+		}
+
+		// juce::Reverb's combs feed back by 0.7 + 0.28 * size every ~37ms, the decay to -60 dB follows from that
+		if (parameters.get(ParameterRegistry::reverbEnabled) >= 0.5f)
+		{
+			double feedback = 0.7 + 0.28 * parameters.get(ParameterRegistry::reverbSize);
+			tail += reverbCombSeconds * std::log(0.001) / std::log(feedback);
+		}
+
+		return tail;
+	}
+
+private:
+	static constexpr double reverbCombSeconds = 1617.0 / 44100.0; // juce::Reverb's longest comb delay
+
+	juce::dsp::Chorus<float> chorus;
+	juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> delayLine;
+	juce::dsp::Reverb reverb;
+	juce::dsp::Reverb::Parameters appliedReverbParameters{ -1.0f, -1.0f, -1.0f, -1.0f };
+
+	double currentSampleRate = 44100.0;
+	juce::SmoothedValue<float> delaySamples;
+	float delayFeedback = 0.0f;
+	float delayMix = 0.0f;
+
+	// How much of each effect's output is heard, 0 is bypassed
+	juce::SmoothedValue<float> chorusLevel;
+	juce::SmoothedValue<float> delayLevel;
+	juce::SmoothedValue<float> reverbLevel;
+
+	// Input to an effect that is fading, and the fade for one chunk of it
+	juce::AudioBuffer<float> dryBuffer;
+	alignas(32) std::array<float, fadeChunkSize> fadeRamp{};
+
+	static bool isRunning(const juce::SmoothedValue<float>& level)
+	{
+		return level.getCurrentValue() > 0.0f || level.getTargetValue() > 0.0f;
+	}
+
+	// Runs an effect in place. While it fades the output is dry + (wet - dry) * level, ramped a chunk at a time
+	template <typename ProcessEffect>
+	void processFaded(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples, juce::SmoothedValue<float>& level,
+		ProcessEffect&& processEffect)
+	{
+		if (!level.isSmoothing())
+		{
+			processEffect();
+			return;
+		}
+
+		jassert(numChannels <= dryBuffer.getNumChannels() && numSamples <= dryBuffer.getNumSamples());
+
+		for (int channel = 0; channel < numChannels; ++channel)
+			dryBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+		processEffect();
+
+		for (int start = 0; start < numSamples; start += fadeChunkSize)
+		{
+			int chunk = juce::jmin(fadeChunkSize, numSamples - start);
+
+			for (int i = 0; i < chunk; ++i)
+				fadeRamp[static_cast<size_t>(i)] = level.getNextValue();
+
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				float* samples = buffer.getWritePointer(channel, start);
+				const float* dry = dryBuffer.getReadPointer(channel, start);
+
+				juce::FloatVectorOperations::subtract(samples, dry, chunk);
+				juce::FloatVectorOperations::multiply(samples, fadeRamp.data(), chunk);
+				juce::FloatVectorOperations::add(samples, dry, chunk);
+			}
+		}
+	}
+
+	// Feedback delay, sample by sample across the channels so they share the smoothed delay time
+	void processDelay(const juce::dsp::ProcessContextReplacing<float>& context)
+	{
+		auto& block = context.getOutputBlock();
+		auto numChannels = static_cast<int>(block.getNumChannels());
+		auto numSamples = block.getNumSamples();
+
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			float delay = delaySamples.getNextValue();
+
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				float* samples = block.getChannelPointer(static_cast<size_t>(channel));
+				float input = samples[i];
+				float delayed = delayLine.popSample(channel, delay);
+
+				delayLine.pushSample(channel, input + delayed * delayFeedback);
+				samples[i] = input + (delayed - input) * delayMix;
+			}
+		}
+	}
+};
+
+static_assert(ParameterRegistry::globalSpecs[ParameterRegistry::delayTime].maximum == EffectsChain::maxDelaySeconds,
+	"Delay time range must fit the delay line");
\ No newline at end of file
@@ -0,0 +1,313 @@
+/*
+  ==============================================================================
+
+    Envelope.h
+    Created: 17 Oct 2026 11:04:52pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// ADSR envelope rendered a segment at a time. Each pass works out how many samples are left in the
+// current stage and fills that whole run in one branch-free loop, so the per-sample stage checks
+// of juce::ADSR::getNextSample never reach the inner loop.
+//
+// Linear curves match juce::ADSR. Exponential curves are RC-style: attack rises towards a target
+// above 1, decay and release fall towards a target just below their end level, and each stage still
+// takes its set time from start to end. They are filled from the closed form rather than the
+// recurrence, so the samples of a run do not depend on each other either.
+//
+// Coefficients and State are kept apart so one set of coefficients, calculated when the parameters
+// change, is shared by every voice playing with them.
+class Envelope
+{
+public:
+	enum Curve : int
+	{
+		linear = 0,
+		exponential
+	};
+
+	enum Stage : int
+	{
+		idle = 0,
+		attack,
+		decay,
+		sustain,
+		release
+	};
+
+	struct Parameters
+	{
+		float attack = 0.1f;
+		float decay = 0.1f;
+		float sustain = 1.0f;
+		float release = 0.1f;
+		int curve = linear;
+	};
+
+	// Per-sample rates and coefficients for one set of parameters at one sample rate
+	struct Coefficients
+	{
+		void calculate(const Parameters& parameters, double sampleRate)
+		{
+			auto rate = static_cast<float>(sampleRate);
+			curve = parameters.curve;
+			sustainLevel = parameters.sustain;
+
+			// Rates of zero or less mean the stage is skipped, as in juce::ADSR
+			attackRate = parameters.attack > 0.0f ? 1.0f / (parameters.attack * rate) : -1.0f;
+			decayRate = parameters.decay > 0.0f ? (1.0f - sustainLevel) / (parameters.decay * rate) : -1.0f;
+			releaseSamples = parameters.release * rate;
+
+			// Each covers its own distance to its target, so decay lasts its set time whatever the sustain level
+			attackCoefficient = getCoefficient(parameters.attack * rate, 1.0f + attackTargetRatio, attackTargetRatio);
+			decayCoefficient = getCoefficient(parameters.decay * rate, 1.0f - sustainLevel + decayTargetRatio, decayTargetRatio);
+		}
+
+		int curve = linear;
+		float sustainLevel = 1.0f;
+		float attackRate = -1.0f;
+		float decayRate = -1.0f;
+		float releaseSamples = 0.0f;
+		float attackCoefficient = 0.0f;
+		float decayCoefficient = 0.0f;
+	};
+
+	struct State
+	{
+		int stage = idle;
+		float level = 0.0f;
+		float releaseRate = 0.0f; // Linear release falls from the level at note off
+		float releaseCoefficient = 0.0f; // As does exponential release, so both take the release time
+	};
+
+	//==============================================================================
+	static void start(const Coefficients& c, State& state)
+	{
+		if (c.attackRate > 0.0f)
+		{
+			state.stage = attack;
+		}
+		else if (c.decayRate > 0.0f)
+		{
+			state.level = 1.0f;
+			state.stage = decay;
+		}
+		else
+		{
+			state.level = c.sustainLevel;
+			state.stage = sustain;
+		}
+	}
+
+	static void stop(const Coefficients& c, State& state)
+	{
+		if (state.stage == idle)
+			return;
+
+		if (c.releaseSamples > 0.0f)
+		{
+			state.releaseRate = state.level / c.releaseSamples;
+			state.releaseCoefficient = c.curve == exponential
+				? getCoefficient(c.releaseSamples, state.level + decayTargetRatio, decayTargetRatio) : 0.0f;
+			state.stage = release;
+		}
+		else
+		{
+			state = State();
+		}
+	}
+
+	// Overwrites numSamples of output with the envelope, advancing the state
+	static void render(const Coefficients& c, State& state, float* output, int numSamples)
+	{
+		int i = 0;
+
+		while (i < numSamples)
+		{
+			int remaining = numSamples - i;
+
+			switch (state.stage)
+			{
+				case attack:
+				{
+					if (c.attackRate <= 0.0f)
+					{
+						state.level = 1.0f;
+						state.stage = c.decayRate > 0.0f ? decay : sustain;
+						break;
+					}
+
+					int length = c.curve == exponential
+						? getExponentialLength(state.level, 1.0f, 1.0f + attackTargetRatio, c.attackCoefficient)
+						: getLinearLength(1.0f - state.level, c.attackRate);
+
+					i += fillSegment(output + i, state, remaining, length, 1.0f, c.attackRate, 1.0f + attackTargetRatio, c.attackCoefficient, c.curve);
+
+					if (length <= remaining)
+						state.stage = c.decayRate > 0.0f ? decay : sustain;
+					break;
+				}
+
+				case decay:
+				{
+					if (c.decayRate <= 0.0f || state.level <= c.sustainLevel)
+					{
+						state.stage = sustain;
+						break;
+					}
+
+					int length = c.curve == exponential
+						? getExponentialLength(state.level, c.sustainLevel, c.sustainLevel - decayTargetRatio, c.decayCoefficient)
+						: getLinearLength(state.level - c.sustainLevel, c.decayRate);
+
+					i += fillSegment(output + i, state, remaining, length, c.sustainLevel, -c.decayRate, c.sustainLevel - decayTargetRatio, c.decayCoefficient, c.curve);
+
+					if (length <= remaining)
+						state.stage = sustain;
+					break;
+				}
+
+				case sustain:
+					state.level = c.sustainLevel;
+					juce::FloatVectorOperations::fill(output + i, state.level, remaining);
+					i = numSamples;
+					break;
+
+				case release:
+				{
+					if (state.level <= 0.0f)
+					{
+						state = State();
+						break;
+					}
+
+					int length = c.curve == exponential
+						? getExponentialLength(state.level, 0.0f, -decayTargetRatio, state.releaseCoefficient)
+						: getLinearLength(state.level, state.releaseRate);
+
+					i += fillSegment(output + i, state, remaining, length, 0.0f, -state.releaseRate, -decayTargetRatio, state.releaseCoefficient, c.curve);
+
+					if (length <= remaining)
+						state = State();
+					break;
+				}
+
+				default:
+					juce::FloatVectorOperations::clear(output + i, remaining);
+					i = numSamples;
+					break;
+			}
+		}
+	}
+
+private:
+	// How far past the end level the exponential stages aim, as a fraction of full scale
+	static constexpr float attackTargetRatio = 0.3f;
+	static constexpr float decayTargetRatio = 0.0001f;
+
+	// Exponential runs are filled this many samples at a time from one table of powers
+	static constexpr int exponentialChunkSize = 16;
+
+	// Per-sample multiplier that shrinks the distance to the target from startDistance to endDistance
+	// in numSamples
+	static float getCoefficient(float numSamples, float startDistance, float endDistance)
+	{
+		if (numSamples <= 0.0f)
+			return 0.0f;
+
+		return std::exp(-std::log(startDistance / endDistance) / numSamples);
+	}
+
+	// Longest stage length worked out in one go. A longer stage just carries on into the next block,
+	// where its length is worked out again.
+	static constexpr int maxSegmentLength = 1 << 30;
+
+	// Rounds a sample count up, clamped to [1, maxSegmentLength] before it becomes an int. Infinite
+	// counts and NaN clamp to the maximum.
+	static int toSegmentLength(float numSamples)
+	{
+		if (!(numSamples < static_cast<float>(maxSegmentLength)))
+			return maxSegmentLength;
+
+		return juce::jmax(1, static_cast<int>(std::ceil(numSamples)));
+	}
+
+	// Samples until a linear stage covers distance, at least one
+	static int getLinearLength(float distance, float rate)
+	{
+		return toSegmentLength(distance / rate);
+	}
+
+	// Samples until level, heading for target, reaches end, at least one
+	static int getExponentialLength(float level, float end, float target, float coefficient)
+	{
+		if (coefficient <= 0.0f)
+			return 1;
+
+		// A coefficient that rounded to one never closes the distance
+		if (coefficient >= 1.0f)
+			return maxSegmentLength;
+
+		float ratio = (end - target) / (level - target);
+
+		if (ratio <= 0.0f || ratio >= 1.0f)
+			return 1;
+
+		return toSegmentLength(std::log(ratio) / std::log(coefficient));
+	}
+
+	// Fills the next run of a stage and returns the samples written. When the run reaches the end of
+	// the stage its last sample lands exactly on the end level.
+	static int fillSegment(float* output, State& state, int remaining, int length, float end,
+		float step, float target, float coefficient, int curve)
+	{
+		int count = juce::jmin(remaining, length);
+		float level = state.level;
+
+		if (curve == exponential)
+		{
+			// level_k = target + (level - target) * coefficient^k, one chunk of powers at a time
+			std::array<float, exponentialChunkSize> powers;
+			float power = 1.0f;
+
+			for (size_t k = 0; k < static_cast<size_t>(juce::jmin(count, exponentialChunkSize)); ++k)
+			{
+				power *= coefficient;
+				powers[k] = power;
+			}
+
+			float distance = level - target;
+
+			for (int start = 0; start < count; start += exponentialChunkSize)
+			{
+				int run = juce::jmin(exponentialChunkSize, count - start);
+
+				for (int k = 0; k < run; ++k)
+					output[start + k] = target + distance * powers[static_cast<size_t>(k)];
+
+				distance *= powers[static_cast<size_t>(run - 1)];
+			}
+		}
+		else
+		{
+			for (int k = 0; k < count; ++k)
+				output[k] = level + step * static_cast<float>(k + 1);
+		}
+
+		state.level = output[count - 1];
+
+		if (length <= remaining)
+		{
+			output[count - 1] = end;
+			state.level = end;
+		}
+
+		return count;
+	}
+};
\ No newline at end of file
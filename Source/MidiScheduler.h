@@ -0,0 +1,209 @@
+/*
+  ==============================================================================
+
+    MidiScheduler.h
+    Created: 17 Oct 2026 10:21:36pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterEventBuffer.h"
+
+// Splits a block into sub-blocks around its MIDI events.
+// Notes, pedals and channel mode messages split the block on their exact sample. Continuous
+// controllers, pitch wheel and pressure only split once the current sub-block has reached the
+// minimum size. Until then they are held back, and a later value for the same controller replaces
+// the earlier one, so a dense stream costs one update per sub-block rather than one per event.
+// Timestamped parameter changes are merged in with the MIDI and coalesced like controllers, so a
+// dense automation lane also costs at most one sub-block per minimumSubBlockSize samples.
+// Held-back events are applied at the start of the sub-block they fall in, so they land at most
+// minimumSubBlockSize - 1 samples early.
+// System messages (clock, active sensing, sysex) are skipped, since the synth ignores them anyway.
+class MidiScheduler
+{
+public:
+	static constexpr int maxPendingEvents = 64;
+	static constexpr int maxPendingParameterEvents = 64;
+
+	void setMinimumSubBlockSize(int numSamples)
+	{
+		minimumSubBlockSize = juce::jmax(1, numSamples);
+	}
+
+	int getMinimumSubBlockSize() const
+	{
+		return minimumSubBlockSize;
+	}
+
+	// Calls handleEvent(message) for each MIDI event, parameterEvents.apply(event) for each parameter
+	// change and render(startSample, numSamples) for each sub-block, in time order
+	template <typename RenderCallback, typename EventCallback>
+	void process(const juce::MidiBuffer& midiMessages, const ParameterEventBuffer& parameterEvents, int startSample, int numSamples,
+		RenderCallback&& render, EventCallback&& handleEvent)
+	{
+		int endSample = startSample + numSamples;
+		numPending = 0;
+		numPendingParameters = 0;
+
+		auto midiIterator = midiMessages.begin();
+		auto midiEnd = midiMessages.end();
+		const auto* parameterIterator = parameterEvents.begin();
+		const auto* parameterEnd = parameterEvents.end();
+
+		while (midiIterator != midiEnd || parameterIterator != parameterEnd)
+		{
+			// MIDI goes first when both land on the same sample
+			bool isMidi = midiIterator != midiEnd
+				&& (parameterIterator == parameterEnd || (*midiIterator).samplePosition <= parameterIterator->samplePosition);
+
+			int eventPosition;
+			bool exact = false;
+			juce::MidiMessage message;
+
+			if (isMidi)
+			{
+				const auto metadata = *midiIterator;
+
+				// Clock, active sensing, sysex and other system messages mean nothing to the voices,
+				// so they are dropped here rather than splitting the block
+				if (metadata.numBytes == 0 || metadata.data[0] >= 0xf0)
+				{
+					++midiIterator;
+					continue;
+				}
+
+				eventPosition = metadata.samplePosition;
+				message = metadata.getMessage();
+				exact = !canCoalesce(message);
+			}
+			else
+			{
+				eventPosition = parameterIterator->samplePosition;
+			}
+
+			eventPosition = juce::jlimit(startSample, endSample, eventPosition);
+
+			if (eventPosition > startSample && (exact || eventPosition - startSample >= minimumSubBlockSize))
+			{
+				flushPending(parameterEvents, handleEvent);
+				render(startSample, eventPosition - startSample);
+				startSample = eventPosition;
+			}
+
+			if (!isMidi)
+			{
+				addPendingParameter(*parameterIterator, parameterEvents, handleEvent);
+				++parameterIterator;
+			}
+			else if (exact)
+			{
+				// Anything held back happened first
+				flushPending(parameterEvents, handleEvent);
+				handleEvent(message);
+				++midiIterator;
+			}
+			else
+			{
+				addPending(message, parameterEvents, handleEvent);
+				++midiIterator;
+			}
+		}
+
+		flushPending(parameterEvents, handleEvent);
+
+		if (startSample < endSample)
+			render(startSample, endSample - startSample);
+	}
+
+private:
+	int minimumSubBlockSize = 16;
+	std::array<juce::MidiMessage, maxPendingEvents> pendingEvents;
+	std::array<int, maxPendingEvents> pendingKeys{};
+	int numPending = 0;
+	std::array<ParameterEventBuffer::Event, maxPendingParameterEvents> pendingParameterEvents{};
+	int numPendingParameters = 0;
+
+	// Only messages whose latest value is all that matters. Pedals and mode messages change which
+	// notes are held, so they keep their order and timing.
+	static bool canCoalesce(const juce::MidiMessage& message)
+	{
+		if (message.isController())
+		{
+			int controller = message.getControllerNumber();
+			return controller != 64 && controller != 66 && controller != 67 && controller < 120;
+		}
+
+		return message.isPitchWheel() || message.isChannelPressure() || message.isAftertouch();
+	}
+
+	// Status byte (type and channel), plus the controller or note number where the message has one
+	static int getCoalesceKey(const juce::MidiMessage& message)
+	{
+		const auto* data = message.getRawData();
+		int key = static_cast<int>(data[0]) << 8;
+
+		if (message.isController() || message.isAftertouch())
+			key |= static_cast<int>(data[1]);
+
+		return key;
+	}
+
+	template <typename EventCallback>
+	void addPending(const juce::MidiMessage& message, const ParameterEventBuffer& parameterEvents, EventCallback& handleEvent)
+	{
+		int key = getCoalesceKey(message);
+
+		for (int i = 0; i < numPending; ++i)
+		{
+			if (pendingKeys[static_cast<size_t>(i)] == key)
+			{
+				pendingEvents[static_cast<size_t>(i)] = message;
+				return;
+			}
+		}
+
+		if (numPending == maxPendingEvents)
+			flushPending(parameterEvents, handleEvent);
+
+		pendingKeys[static_cast<size_t>(numPending)] = key;
+		pendingEvents[static_cast<size_t>(numPending)] = message;
+		++numPending;
+	}
+
+	template <typename EventCallback>
+	void addPendingParameter(const ParameterEventBuffer::Event& event, const ParameterEventBuffer& parameterEvents, EventCallback& handleEvent)
+	{
+		for (int i = 0; i < numPendingParameters; ++i)
+		{
+			if (pendingParameterEvents[static_cast<size_t>(i)].parameterIndex == event.parameterIndex)
+			{
+				pendingParameterEvents[static_cast<size_t>(i)] = event;
+				return;
+			}
+		}
+
+		if (numPendingParameters == maxPendingParameterEvents)
+			flushPending(parameterEvents, handleEvent);
+
+		pendingParameterEvents[static_cast<size_t>(numPendingParameters)] = event;
+		++numPendingParameters;
+	}
+
+	// Parameters first, so notes started by held-back MIDI see the new values
+	template <typename EventCallback>
+	void flushPending(const ParameterEventBuffer& parameterEvents, EventCallback& handleEvent)
+	{
+		for (int i = 0; i < numPendingParameters; ++i)
+			parameterEvents.apply(pendingParameterEvents[static_cast<size_t>(i)]);
+
+		for (int i = 0; i < numPending; ++i)
+			handleEvent(pendingEvents[static_cast<size_t>(i)]);
+
+		numPendingParameters = 0;
+		numPending = 0;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Created: 18 Oct 2026 1:46:03am
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+// Per-voice modulation, evaluated at control rate and interpolated to audio rate.
+// Sources are only read every controlInterval samples. At each tick the matrix works out the targets'
+// values at the next tick and ramps linearly towards them, so a route costs one multiply-add per
+// tick rather than per sample. The routes are folded into a flat target-by-source depth table, and
+// each tick evaluates every route in one pass over it.
+class ModulationMatrix
+{
+public:
+	enum Source : int
+	{
+		voiceLfo = 0,
+		globalLfo,
+		envelope1,
+		envelope2,
+		velocity,
+		pressure,
+		slide,
+		numSources
+	};
+
+	enum Target : int
+	{
+		pitch = 0,
+		level,
+		pan,
+		detune,
+		numTargets
+	};
+
+	static constexpr int maxRampSize = 64;
+	static constexpr int maxControlInterval = 256;
+
+	// Target change at full depth
+	static constexpr float pitchRange = 12.0f; // Semitones
+	static constexpr float detuneRange = 100.0f; // Unison detune parameter units
+
+	// Routes and LFO rates shared by every voice, updated by the synth between renders
+	struct Routing
+	{
+		void update(const ParameterSnapshot& parameters, double sampleRate, int newControlInterval)
+		{
+			depths.fill(0.0f);
+
+			for (int route = 0; route < ParameterRegistry::numModulationRoutes; ++route)
+			{
+				// Source and target choices start with "Off"
+				auto first = static_cast<size_t>(ParameterRegistry::getModulationIndex(route));
+				int source = static_cast<int>(parameters.values[first]) - 1;
+				int target = static_cast<int>(parameters.values[first + 1]) - 1;
+
+				if (source >= 0 && target >= 0)
+					depths[static_cast<size_t>(target * numSources + source)] += parameters.values[first + 2];
+			}
+
+			anyActive = false;
+			for (int target = 0; target < numTargets; ++target)
+			{
+				auto row = depths.begin() + target * numSources;
+				activeTargets[static_cast<size_t>(target)] = std::any_of(row, row + numSources, [](float depth) { return depth != 0.0f; });
+				anyActive = anyActive || activeTargets[static_cast<size_t>(target)];
+			}
+
+			voiceLfoIncrement = parameters.get(ParameterRegistry::voiceLfoRate) / sampleRate;
+			globalLfoIncrement = parameters.get(ParameterRegistry::globalLfoRate) / sampleRate;
+			controlInterval = juce::jlimit(1, maxControlInterval, newControlInterval);
+		}
+
+		// Called after every voice has rendered numSamples
+		void advanceGlobalLfo(int numSamples)
+		{
+			globalLfoPhase += globalLfoIncrement * numSamples;
+			globalLfoPhase -= std::floor(globalLfoPhase);
+		}
+
+		std::array<float, numTargets * numSources> depths{}; // Target-major
+		std::array<bool, numTargets> activeTargets{};
+		bool anyActive = false;
+		double voiceLfoIncrement = 0.0;
+		double globalLfoIncrement = 0.0;
+		double globalLfoPhase = 0.0; // At the start of the current render
+		int controlInterval = 16;
+	};
+
+	explicit ModulationMatrix(const Routing& sharedRouting) : routing(sharedRouting) {}
+
+	// Restarts the voice LFO, and the next tick starts from the note's own values rather than ramping
+	void startNote()
+	{
+		voiceLfoPhase = 0.0;
+		samplesUntilTick = 0;
+		restarting = true;
+	}
+
+	void setSource(Source source, float value)
+	{
+		sources[static_cast<size_t>(source)] = value;
+	}
+
+	bool isActive(Target target) const
+	{
+		return routing.activeTargets[static_cast<size_t>(target)];
+	}
+
+	// Renders numSamples of each active target into its ramp. Offset is the number of samples since the
+	// start of the current render, which places the global LFO.
+	void process(int offset, int numSamples)
+	{
+		jassert(numSamples <= maxRampSize);
+
+		if (!routing.anyActive)
+			return;
+
+		int i = 0;
+
+		while (i < numSamples)
+		{
+			if (samplesUntilTick == 0)
+			{
+				if (restarting)
+				{
+					evaluate(offset + i, 0);
+					restarting = false;
+				}
+
+				startTargets = endTargets;
+				tickLength = routing.controlInterval;
+				evaluate(offset + i + tickLength, tickLength);
+				samplesUntilTick = tickLength;
+			}
+
+			int run = juce::jmin(samplesUntilTick, numSamples - i);
+			int done = tickLength - samplesUntilTick;
+
+			for (size_t t = 0; t < numTargets; ++t)
+			{
+				if (!routing.activeTargets[t])
+					continue;
+
+				float step = (endTargets[t] - startTargets[t]) / static_cast<float>(tickLength);
+				float start = startTargets[t] + step * static_cast<float>(done);
+				auto* ramp = ramps[t].data() + i;
+
+				for (int k = 0; k < run; ++k)
+					ramp[k] = start + step * static_cast<float>(k + 1);
+			}
+
+			samplesUntilTick -= run;
+			i += run;
+		}
+	}
+
+	const float* getRamp(Target target) const
+	{
+		return ramps[static_cast<size_t>(target)].data();
+	}
+
+	// Value at the last sample of the last process call
+	float getValue(Target target, int numSamples) const
+	{
+		return ramps[static_cast<size_t>(target)][static_cast<size_t>(numSamples - 1)];
+	}
+
+private:
+	const Routing& routing;
+	std::array<float, numSources> sources{};
+	std::array<float, numTargets> startTargets{};
+	std::array<float, numTargets> endTargets{};
+	std::array<std::array<float, maxRampSize>, numTargets> ramps{};
+	double voiceLfoPhase = 0.0;
+	int samplesUntilTick = 0;
+	int tickLength = 1;
+	bool restarting = true;
+
+	// Targets at offset samples into the current render, after the voice LFO moves on lfoSamples
+	void evaluate(int offset, int lfoSamples)
+	{
+		voiceLfoPhase += routing.voiceLfoIncrement * lfoSamples;
+		voiceLfoPhase -= std::floor(voiceLfoPhase);
+
+		double globalPhase = routing.globalLfoPhase + routing.globalLfoIncrement * offset;
+		sources[voiceLfo] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * voiceLfoPhase));
+		sources[globalLfo] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * globalPhase));
+
+		for (size_t t = 0; t < numTargets; ++t)
+		{
+			const float* row = routing.depths.data() + t * numSources;
+			float sum = 0.0f;
+
+			for (size_t s = 0; s < numSources; ++s)
+				sum += row[s] * sources[s];
+
+			endTargets[t] = sum;
+		}
+	}
+};
+
+// Source and target choices are "Off" followed by the enums in order
+static_assert(ParameterRegistry::globalSpecs[ParameterRegistry::modulation1Source].maximum == ModulationMatrix::numSources,
+	"Modulation source choices must match ModulationMatrix::Source");
+static_assert(ParameterRegistry::globalSpecs[ParameterRegistry::modulation1Target].maximum == ModulationMatrix::numTargets,
+	"Modulation target choices must match ModulationMatrix::Target");
\ No newline at end of file
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    NoiseGenerator.h
+    Created: 17 Oct 2026 4:02:15pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// White noise from several interleaved xorshift32 streams. Each lane is independent, so a whole
+// set of lanes is produced by one flat loop the compiler can vectorise. No shared state and no
+// allocation, and the same seed always renders the same samples regardless of block sizes.
+class NoiseGenerator
+{
+public:
+	static constexpr int numLanes = 8;
+
+	void setSeed(juce::uint32 newSeed)
+	{
+		seed = newSeed;
+		reset();
+	}
+
+	// Restarts the streams from the current seed
+	void reset()
+	{
+		// Spread the seed across the lanes with splitmix32 so neighbouring seeds give unrelated streams
+		juce::uint32 x = seed;
+		for (auto& laneState : state)
+		{
+			x += 0x9e3779b9u;
+			juce::uint32 z = x;
+			z = (z ^ (z >> 16)) * 0x85ebca6bu;
+			z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+			z ^= z >> 16;
+			laneState = z != 0 ? z : 0x6d2b79f5u; // xorshift must never hold zero
+		}
+
+		numPending = 0;
+	}
+
+	void process(float* destination, int numSamples)
+	{
+		// Use up anything left over from the previous call first
+		while (numPending > 0 && numSamples > 0)
+		{
+			*destination++ = pending[static_cast<size_t>(numLanes - numPending--)];
+			--numSamples;
+		}
+
+		while (numSamples >= numLanes)
+		{
+			generateLanes(destination);
+			destination += numLanes;
+			numSamples -= numLanes;
+		}
+
+		if (numSamples > 0)
+		{
+			generateLanes(pending.data());
+			numPending = numLanes;
+
+			while (numSamples-- > 0)
+				*destination++ = pending[static_cast<size_t>(numLanes - numPending--)];
+		}
+	}
+
+private:
+	juce::uint32 seed = 1;
+	std::array<juce::uint32, numLanes> state{};
+	alignas(32) std::array<float, numLanes> pending{};
+	int numPending = 0;
+
+	void generateLanes(float* destination)
+	{
+		for (int lane = 0; lane < numLanes; ++lane)
+		{
+			juce::uint32 x = state[static_cast<size_t>(lane)];
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			state[static_cast<size_t>(lane)] = x;
+
+			// Reinterpret as signed and scale into [-1, 1)
+			destination[lane] = static_cast<float>(static_cast<juce::int32>(x)) * (1.0f / 2147483648.0f);
+		}
+	}
+};
\ No newline at end of file
@@ -11,46 +11,177 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "WavetableBank.h"
+#include "NoiseGenerator.h"
+#include "PitchTable.h"
+#include "PanTable.h"
+#include "VoiceBank.h"
 
+// Wavetable oscillator with up to maxUnisonVoices detuned copies (lanes). The lanes' phases,
+// increments and stereo gains live in the oscillator's row of a VoiceBank, and all lanes share the
+// band-limited tables picked for the base frequency. The oscillator keeps the control state and
+// writes the row whenever it changes.
 class Oscillator
 {
 public:
-    void setWaveform(const juce::String& waveformType)
+	static constexpr int maxUnisonVoices = VoiceBank::maxLanes;
+
+	// Call before anything else, every other setter writes to the row
+	void setVoiceBank(VoiceBank& newVoiceBank, int newRow)
+	{
+		voiceBank = &newVoiceBank;
+		row = newRow;
+		voiceBank->setNumLanes(row, numLanes);
+		reset();
+	}
+
+	// Row of the voice bank this oscillator renders from, or -1 while it plays noise, which has no lanes
+	int getBankRow() const
+	{
+		return noiseMode || voiceBank == nullptr ? -1 : row;
+	}
+
+	void setWavetableBank(const WavetableBank& newBank)
+	{
+		bank = &newBank;
+		mipMap = &bank->getMipMap(WavetableBank::sine);
+		selectTables();
+	}
+
+	// Selecting a waveform only swaps the mipmap pointer, the tables themselves are shared and prebuilt
+    void setWaveform(int waveform)
     {
-		if (waveformType == "Sine")
-			osc.initialise([](float x) { return std::sin(x); }, 128);
-		else if (waveformType == "Square")
-			osc.initialise([](float x) { return x < 0.0f ? -1.0f : 1.0f; }, 128);
-		else if (waveformType == "Saw")
-			osc.initialise([](float x) { return (2.0f / juce::MathConstants<float>::pi) * x - 1.0f; }, 128);
-		else if (waveformType == "Triangle")
-			osc.initialise([](float x) { return 2.0f * std::abs(2.0f * (x / juce::MathConstants<float>::twoPi) - 1.0f) - 1.0f; }, 128);
-		else if (waveformType == "Noise")
-			osc.initialise([](float x) { return 2.0f * juce::Random::getSystemRandom().nextFloat() - 1.0f; }, 128);
-		else
-			osc.initialise([](float x) { return std::sin(x); }, 128);
-
-		osc.reset();
+		noiseMode = waveform == WavetableBank::noise;
+
+		if (bank != nullptr && !noiseMode)
+		{
+			mipMap = &bank->getMipMap(waveform);
+			selectTables();
+		}
     }
 
+	void setNoiseSeed(juce::uint32 seed)
+	{
+		noise.setSeed(seed);
+	}
+
+	// Also picks the band-limited tables for the new pitch
 	void setFrequency(float frequency, double sampleRate)
 	{
-		osc.setFrequency(frequency, sampleRate);
+		phaseIncrement = static_cast<float>(frequency / sampleRate);
+		updateLaneIncrements();
+		selectTables();
 	}
 
-	void prepare(const juce::dsp::ProcessSpec& spec)
+	// Lanes are spread evenly across +/- detuneCents and +/- spread in the stereo field.
+	// Mix balances the centre lane(s) against the outer ones, from three lanes up. Only recalculates when something moved.
+	void setUnison(int numVoices, float detuneCents, float mix, float spread)
 	{
-		osc.prepare(spec);
+		numVoices = juce::jlimit(1, maxUnisonVoices, numVoices);
+
+		if (numVoices == numLanes && detuneCents == unisonDetune && mix == unisonMix && spread == unisonSpread)
+			return;
+
+		numLanes = numVoices;
+		unisonDetune = detuneCents;
+		unisonMix = mix;
+		unisonSpread = spread;
+
+		if (voiceBank == nullptr)
+			return;
+
+		voiceBank->setNumLanes(row, numLanes);
+		calculateUnisonLanes(numLanes, detuneCents, mix, spread, laneRatios.data(), voiceBank->getGainsLeft(row), voiceBank->getGainsRight(row));
+		updateLaneIncrements();
 	}
 
-	float getNextSample()
+	// Fills per-lane frequency ratios and stereo gains for a unison stack
+	static void calculateUnisonLanes(int numVoices, float detuneCents, float mix, float spread,
+		float* ratios, float* gainsLeft, float* gainsRight)
 	{
-		return osc.processSample(0.0f);
+		float totalPower = 0.0f;
+
+		for (int lane = 0; lane < numVoices; ++lane)
+		{
+			// Position of the lane across the unison stack, from -1 to 1
+			float position = numVoices > 1 ? 2.0f * static_cast<float>(lane) / static_cast<float>(numVoices - 1) - 1.0f : 0.0f;
+			bool isCentre = numVoices == 1 || std::abs(position) <= 1.0f / static_cast<float>(numVoices - 1) + 1.0e-4f;
+
+			ratios[lane] = PitchTable::getRatio(detuneCents * position / 100.0f);
+
+			// One or two lanes have no outer lanes to balance against, so mix does not apply
+			float gain = numVoices <= 2 ? 1.0f : (isCentre ? 1.0f - mix : mix);
+			totalPower += gain * gain;
+
+			PanTable::getGains(spread * position, gainsLeft[lane], gainsRight[lane]);
+			gainsLeft[lane] *= gain;
+			gainsRight[lane] *= gain;
+		}
+
+		// Detuned lanes are uncorrelated, so normalise by their summed power
+		float normalisation = totalPower > 0.0f ? 1.0f / std::sqrt(totalPower) : 0.0f;
+
+		for (int lane = 0; lane < numVoices; ++lane)
+		{
+			gainsLeft[lane] *= normalisation;
+			gainsRight[lane] *= normalisation;
+		}
+	}
+
+	// Mipmap levels and crossfade for a phase increment
+	static void selectTables(const WavetableBank::MipMap& mipMap, float phaseIncrement,
+		const WavetableBank::Table*& lower, const WavetableBank::Table*& upper, float& crossfade)
+	{
+		float level = WavetableBank::getLevelForIncrement(phaseIncrement);
+		int lowerLevel = static_cast<int>(level);
+		int upperLevel = juce::jmin(lowerLevel + 1, WavetableBank::numLevels - 1);
+
+		lower = &mipMap[static_cast<size_t>(lowerLevel)];
+		upper = &mipMap[static_cast<size_t>(upperLevel)];
+		crossfade = level - static_cast<float>(lowerLevel);
+	}
+
+	// Also restarts the noise stream, so every render after a prepare starts from the same samples
+	void prepare(const juce::dsp::ProcessSpec& /*spec*/)
+	{
+		reset();
+		noise.reset();
+	}
+
+	// Renders a run of stereo samples, overwriting left and right
+	void process(float* left, float* right, int numSamples)
+	{
+		if (noiseMode)
+		{
+			// Unison has no meaning for noise, render one centred lane
+			noise.process(left, numSamples);
+			juce::FloatVectorOperations::copy(right, left, numSamples);
+			return;
+		}
+
+		if (voiceBank == nullptr)
+		{
+			juce::FloatVectorOperations::clear(left, numSamples);
+			juce::FloatVectorOperations::clear(right, numSamples);
+			return;
+		}
+
+		voiceBank->renderRow(row, left, right, numSamples, scratch);
 	}
 
 	void reset()
 	{
-		osc.reset();
+		if (voiceBank == nullptr)
+			return;
+
+		// Start the lanes at spread-out phases so a unison stack does not begin phase aligned
+		float* phases = voiceBank->getPhases(row);
+
+		for (int lane = 0; lane < maxUnisonVoices; ++lane)
+		{
+			float offset = static_cast<float>(lane) * 0.618034f;
+			phases[lane] = offset - std::floor(offset);
+		}
 	}
 
 	void setActive(bool shouldBeActive)
@@ -63,6 +194,44 @@ public:
 		return active;
 	}
 private:
-	juce::dsp::Oscillator<float> osc;
+	VoiceBank* voiceBank = nullptr;
+	int row = 0;
+	VoiceBank::Scratch scratch;
+
+	// Control state for the lanes in the bank row
+	alignas(32) std::array<float, maxUnisonVoices> laneRatios{ 1.0f };
+	int numLanes = 1;
+	float unisonDetune = 0.0f;
+	float unisonMix = -1.0f; // Forces the first setUnison call to fill the lanes
+	float unisonSpread = 0.0f;
+
+	const WavetableBank* bank = nullptr;
+	const WavetableBank::MipMap* mipMap = nullptr;
+	float phaseIncrement = 0.0f;
+	NoiseGenerator noise;
+	bool noiseMode = false;
 	bool active;
+
+	void updateLaneIncrements()
+	{
+		if (voiceBank == nullptr)
+			return;
+
+		float* increments = voiceBank->getIncrements(row);
+
+		for (int lane = 0; lane < maxUnisonVoices; ++lane)
+			increments[lane] = phaseIncrement * laneRatios[lane];
+	}
+
+	void selectTables()
+	{
+		if (mipMap == nullptr || voiceBank == nullptr)
+			return;
+
+		const WavetableBank::Table* lower = nullptr;
+		const WavetableBank::Table* upper = nullptr;
+		float crossfade = 0.0f;
+		selectTables(*mipMap, phaseIncrement, lower, upper, crossfade);
+		voiceBank->setTables(row, lower, upper, crossfade);
+	}
 };
\ No newline at end of file
@@ -13,51 +13,46 @@
 #include <JuceHeader.h>
 #include "OscillatorSound.h"
 #include "Oscillator.h"
-
+#include "VoiceBank.h"
+#include "PitchTable.h"
+#include "PanTable.h"
+#include "Envelope.h"
+#include "ParameterSnapshot.h"
+#include "SmoothedParameter.h"
+#include "ModulationMatrix.h"
+
+// A voice renders in chunks of up to renderChunkSize samples, laid on a grid from the start of each
+// render call. Each chunk is control work, then the oscillators, then the mix into the voice's output.
+// renderNextBlock runs all three itself. The synth's serial render runs them as separate passes over
+// every voice, so the oscillators of all voices render in one sweep of the VoiceBank. Both orders do
+// the same arithmetic, so they produce the same samples.
 class OscillatorVoice : public juce::SynthesiserVoice
 {
 public:
-	void setParameters(juce::AudioProcessorValueTreeState& apvts)
+	static constexpr int numOscillators = ParameterRegistry::numOscillators;
+	static constexpr int renderChunkSize = VoiceBank::chunkSize;
+
+	// Envelope coefficients for each oscillator, owned by the synth and shared by all its voices
+	using EnvelopeCoefficients = std::array<Envelope::Coefficients, numOscillators>;
+
+	// The parameter snapshot is refreshed by the processor at the top of each block. The voice's
+	// oscillators use rows voiceIndex * numOscillators onwards of the voice bank.
+	OscillatorVoice(const WavetableBank& wavetableBank, VoiceBank& voiceBank, const ParameterSnapshot& parameterSnapshot,
+		const EnvelopeCoefficients& sharedEnvelopeCoefficients, const Envelope::Coefficients& sharedFilterEnvelopeCoefficients,
+		const ModulationMatrix::Routing& modulationRouting, int voiceIndex)
+		: parameters(parameterSnapshot), envelopeCoefficients(sharedEnvelopeCoefficients), modulation(modulationRouting),
+		  filterEnvelopeCoefficients(sharedFilterEnvelopeCoefficients)
 	{
-		// Oscillator 1 parameters
-		osc1_active = apvts.getRawParameterValue("osc1_active");
-		osc1_waveform = apvts.getRawParameterValue("osc1_waveform");
-		osc1_octave = apvts.getRawParameterValue("osc1_octave");
-		osc1_semitone = apvts.getRawParameterValue("osc1_semitone");
-		osc1_fine = apvts.getRawParameterValue("osc1_fine");
-
-		osc1_attack = apvts.getRawParameterValue("osc1_attack");
-		osc1_decay = apvts.getRawParameterValue("osc1_decay");
-		osc1_sustain = apvts.getRawParameterValue("osc1_sustain");
-		osc1_release = apvts.getRawParameterValue("osc1_release");
-
-
-		osc1_voices = apvts.getRawParameterValue("osc1_voices");
-		osc1_voicesDetune = apvts.getRawParameterValue("osc1_voicesDetune");
-		osc1_voicesMix = apvts.getRawParameterValue("osc1_voicesMix");
-		osc1_voicesPan = apvts.getRawParameterValue("osc1_voicesPan");
-		osc1_level = apvts.getRawParameterValue("osc1_level");
-		osc1_pan = apvts.getRawParameterValue("osc1_pan");
-
-		// Oscillator 2 parameters
-		osc2_active = apvts.getRawParameterValue("osc2_active");
-		osc2_waveform = apvts.getRawParameterValue("osc2_waveform");
-		osc2_octave = apvts.getRawParameterValue("osc2_octave");
-		osc2_semitone = apvts.getRawParameterValue("osc2_semitone");
-		osc2_fine = apvts.getRawParameterValue("osc2_fine");
-
-		osc2_attack = apvts.getRawParameterValue("osc2_attack");
-		osc2_decay = apvts.getRawParameterValue("osc2_decay");
-		osc2_sustain = apvts.getRawParameterValue("osc2_sustain");
-		osc2_release = apvts.getRawParameterValue("osc2_release");
+		jassert(juce::isPositiveAndBelow(voiceIndex, ParameterRegistry::maxVoices));
 
+		for (size_t i = 0; i < oscillators.size(); ++i)
+		{
+			oscillators[i].setVoiceBank(voiceBank, VoiceBank::getRow(voiceIndex, static_cast<int>(i)));
+			oscillators[i].setWavetableBank(wavetableBank);
 
-		osc2_voices = apvts.getRawParameterValue("osc2_voices");
-		osc2_voicesDetune = apvts.getRawParameterValue("osc2_voicesDetune");
-		osc2_voicesMix = apvts.getRawParameterValue("osc2_voicesMix");
-		osc2_voicesPan = apvts.getRawParameterValue("osc2_voicesPan");
-		osc2_level = apvts.getRawParameterValue("osc2_level");
-		osc2_pan = apvts.getRawParameterValue("osc2_pan");
+			// Fixed per-voice seeds keep noise deterministic for offline renders
+			oscillators[i].setNoiseSeed(static_cast<juce::uint32>(voiceIndex * 2 + static_cast<int>(i)) + 1);
+		}
 	}
 
 	bool canPlaySound(juce::SynthesiserSound* sound) override
@@ -70,25 +65,87 @@ public:
 		juce::dsp::ProcessSpec spec{ sampleRate, (juce::uint32)samplesPerBlock, 1 };
 		for (auto& osc : oscillators)
 			osc.prepare(spec);
+
+		for (auto& smoother : pitchSmoothers)
+			smoother.reset(sampleRate, pitchGlideSeconds);
+
+		for (size_t i = 0; i < levelSmoothers.size(); ++i)
+		{
+			levelSmoothers[i].reset(sampleRate, mixSmoothingSeconds);
+			panSmoothers[i].reset(sampleRate, mixSmoothingSeconds);
+			detuneSmoothers[i].reset(sampleRate, mixSmoothingSeconds);
+			unisonMixSmoothers[i].reset(sampleRate, mixSmoothingSeconds);
+			spreadSmoothers[i].reset(sampleRate, mixSmoothingSeconds);
+		}
+
+		stealFadeSamples = juce::jmax(1, juce::roundToInt(sampleRate * stealFadeSeconds));
+
+		pressureSmoother.reset(sampleRate, expressionSmoothingSeconds);
+		slideSmoother.reset(sampleRate, expressionSmoothingSeconds);
+
+		filterEnvelope.assign(static_cast<size_t>(juce::jmax(1, samplesPerBlock)), 0.0f);
 	}
 
-	void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound*, int /*currentPitchWheelPosition*/) override
+	// In MPE mode the voice's own channel carries its per-note pitch bend, pressure and slide
+	void setMpeMode(bool shouldUseMpe)
 	{
-		// Reset ADSR envelopes and oscillators (prevent phase issues)
-		osc1_adsr.reset();
-		osc2_adsr.reset();
-		for (auto& osc : oscillators)
-			osc.reset();
+		mpeMode = shouldUseMpe;
+	}
+
+	// Zone-wide bend from the MPE master channel, added on top of the note's own bend
+	void setMasterPitchBend(float semitones)
+	{
+		masterPitchBendSemitones = semitones;
+	}
+
+	// Snaps pressure and slide to the values last sent on the note's channel, call after starting a note
+	void resetExpression(float pressure, float slide)
+	{
+		pressureSmoother.setCurrentAndTargetValue(pressure);
+		slideSmoother.setCurrentAndTargetValue(slide);
+	}
+
+	// Smoothed slide (CC 74) from 0 to 1
+	float getSlide() const
+	{
+		return slideSmoother.getCurrentValue();
+	}
+
+	// Called by the allocator just before this voice is restarted with a new note. The old note is
+	// faded out over a couple of milliseconds and the new one starts once it is silent.
+	void steal()
+	{
+		stealRequested = true;
+	}
+
+	// Loudest envelope output at the end of the last rendered chunk, used to rank voices for stealing
+	float getEnvelopeLevel() const
+	{
+		return juce::jmax(envelopeLevels[0], envelopeLevels[1]);
+	}
+
+	// Filter envelope for each sample of the last renderNextBlock, from its start sample. Only written
+	// while the filter is on and the render fits the block size given to prepareToPlay.
+	const float* getFilterEnvelope() const
+	{
+		return filterEnvelope.data();
+	}
 
-		updateEnvelopeParameters();
+	void startNote(int midiNoteNumber, float velocity, juce::SynthesiserSound*, int currentPitchWheelPosition) override
+	{
+		if (stealRequested)
+		{
+			stealRequested = false;
 
-		double baseFrequency = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
+			// Stealing a voice that is already fading keeps the fade going rather than jumping back up
+			if (stealFadeRemaining == 0)
+				stealFadeRemaining = stealFadeSamples;
+
+			pendingNote = { midiNoteNumber, velocity, currentPitchWheelPosition, false };
+			return;
+		}
 
-		updateOscillatorParameters(baseFrequency);
-		oscLevels[0] = *osc1_level * velocity;
-		oscLevels[1] = *osc2_level * velocity;
-		osc1_adsr.noteOn();
-		osc2_adsr.noteOn();
+		beginNote(midiNoteNumber, velocity, currentPitchWheelPosition);
 	}
 
 	void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
@@ -96,119 +153,623 @@ public:
 		if (!isVoiceActive()) // Do not process if the voice is not active
 			return;
 
-		updateEnvelopeParameters();
+		beginRender(numSamples);
+
+		while (numSamples > 0 && isVoiceActive())
+		{
+			int numThisTime = juce::jmin(numSamples, renderChunkSize);
+			renderGridChunk(outputBuffer, startSample, numThisTime);
+
+			startSample += numThisTime;
+			numSamples -= numThisTime;
+		}
+	}
+
+	// Picks up parameter changes at the start of a render of numSamples, before its first chunk
+	void beginRender(int numSamples)
+	{
+		updateUnisonTargets();
+		for (size_t i = 0; i < oscillators.size(); ++i)
+			applyUnison(i);
+
+		updatePitchTargets();
+		updateMixTargets();
+		renderPosition = 0;
+		renderLength = numSamples;
+	}
+
+	// First pass of a chunk in the synth's bank render, writing to outputBuffer from startSample.
+	// A voice that is fading out a stolen note or has gone silent renders the whole chunk here and
+	// returns false. Otherwise the chunk's control work is done, and the rows from getBankRows are left
+	// for the voice bank to render before finishBankChunk.
+	bool prepareBankChunk(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+	{
+		if (stealFadeRemaining > 0 || isTailSilent())
+		{
+			renderGridChunk(outputBuffer, startSample, numSamples);
+			return false;
+		}
+
+		prepareChunk(numSamples);
+
+		// Noise has no lanes in the bank, so it renders here
+		for (size_t i = 0; i < oscillators.size(); ++i)
+			if (renderingOscillators[i] && oscillators[i].getBankRow() < 0)
+				oscillators[i].process(oscLeft[i].data(), oscRight[i].data(), numSamples);
+
+		return true;
+	}
+
+	// Rows the voice bank renders for the prepared chunk, with the buffers each one renders into.
+	// Returns how many were written, at most numOscillators.
+	int getBankRows(int* rows, float** lefts, float** rights)
+	{
+		int numRows = 0;
 
-		while (--numSamples >= 0)
+		for (size_t i = 0; i < oscillators.size(); ++i)
 		{
-			float currentSample = 0.0f;
-			int numActiveOscillators = 0;
+			int row = oscillators[i].getBankRow();
 
-			if (oscillators[0].isActive())
+			if (renderingOscillators[i] && row >= 0)
 			{
-				float sample = oscillators[0].getNextSample();
-				float env = osc1_adsr.getNextSample();
-				currentSample += sample * env * oscLevels[0];
-				++numActiveOscillators;
+				rows[numRows] = row;
+				lefts[numRows] = oscLeft[i].data();
+				rights[numRows] = oscRight[i].data();
+				++numRows;
 			}
+		}
 
-			if (oscillators[1].isActive())
+		return numRows;
+	}
+
+	// Last pass of a chunk in the bank render, once the bank has rendered the voice's rows
+	void finishBankChunk(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+	{
+		mixChunk(numSamples);
+		writeChunk(outputBuffer, startSample, numSamples);
+		renderPosition += numSamples;
+	}
+
+	void stopNote(float /*velocity*/, bool allowTailOff) override
+	{
+		// The synth stops a voice before restarting it, a stolen voice keeps sounding until its fade ends
+		if (stealRequested)
+			return;
+
+		if (stealFadeRemaining > 0)
+		{
+			if (allowTailOff)
+			{
+				pendingNote.released = true;
+			}
+			else
 			{
-				float sample = oscillators[1].getNextSample();
-				float env = osc2_adsr.getNextSample();
-				currentSample += sample * env * oscLevels[1];
-				++numActiveOscillators;
+				stealFadeRemaining = 0;
+				clearCurrentNote();
 			}
 
-			if (numActiveOscillators > 0)
-				currentSample *= 1.0f / std::sqrt(static_cast<float>(numActiveOscillators)); // Normalise the output according to power summation principle
+			return;
+		}
+
+		for (size_t i = 0; i < envelopeStates.size(); ++i)
+			Envelope::stop(envelopeCoefficients[i], envelopeStates[i]);
+
+		Envelope::stop(filterEnvelopeCoefficients, filterEnvelopeState);
+		noteReleased = true;
+
+		if (!allowTailOff || !isEnvelopeActive(0) && !isEnvelopeActive(1))
+			clearCurrentNote();
+	}
+
+	void pitchWheelMoved(int newValue) override
+	{
+		pitchBendSemitones = static_cast<float>(newValue - 8192) / 8192.0f * (mpeMode ? mpeNotePitchBendRange : pitchBendRange);
+		pendingNote.pitchWheelPosition = newValue;
+	}
+
+	void controllerMoved(int controllerNumber, int newValue) override
+	{
+		if (controllerNumber == slideController)
+			slideSmoother.setTargetValue(static_cast<float>(newValue) / 127.0f);
+	}
+
+	void channelPressureChanged(int newChannelPressureValue) override
+	{
+		pressureSmoother.setTargetValue(static_cast<float>(newChannelPressureValue) / 127.0f);
+	}
 
-			for (int i = outputBuffer.getNumChannels(); --i >= 0;)
-				outputBuffer.addSample(i, startSample, currentSample);
+	// Polyphonic aftertouch is per-note pressure as well
+	void aftertouchChanged(int newAftertouchValue) override
+	{
+		pressureSmoother.setTargetValue(static_cast<float>(newAftertouchValue) / 127.0f);
+	}
+
+private:
+	struct PendingNote
+	{
+		int midiNoteNumber = 0;
+		float velocity = 0.0f;
+		int pitchWheelPosition = 8192;
+		bool released = false;
+	};
+
+	using ChunkBuffer = std::array<float, renderChunkSize>;
+
+	static constexpr float silenceThreshold = 1.0e-6f; // -120 dB
+	alignas(32) std::array<float, renderChunkSize> voiceLeft{};
+	alignas(32) std::array<float, renderChunkSize> voiceRight{};
+	alignas(32) std::array<ChunkBuffer, numOscillators> oscLeft{};
+	alignas(32) std::array<ChunkBuffer, numOscillators> oscRight{};
+	alignas(32) std::array<float, renderChunkSize> envelopeBuffer{};
+	alignas(32) std::array<float, renderChunkSize> rampBuffer{};
+
+	const ParameterSnapshot& parameters;
+	std::array<Oscillator, numOscillators> oscillators;
+	const EnvelopeCoefficients& envelopeCoefficients;
+	std::array<Envelope::State, numOscillators> envelopeStates;
+	std::array<float, 2> envelopeLevels = { 0.0f, 0.0f };
+	float noteVelocity = 0.0f;
+	bool noteReleased = false;
+
+	// Level and pan follow their parameters through a held note, ramped per sample only while they move
+	static constexpr double mixSmoothingSeconds = 0.02;
+	std::array<SmoothedParameter, 2> levelSmoothers;
+	std::array<SmoothedParameter, 2> panSmoothers;
+	std::array<float, 2> panGainsLeft = { 1.0f, 1.0f };
+	std::array<float, 2> panGainsRight = { 1.0f, 1.0f };
+
+	// Unison detune, mix and spread glide like level and pan, but reach the lanes once per chunk
+	std::array<SmoothedParameter, 2> detuneSmoothers;
+	std::array<SmoothedParameter, 2> unisonMixSmoothers;
+	std::array<SmoothedParameter, 2> spreadSmoothers;
+
+	// Voice stealing
+	static constexpr double stealFadeSeconds = 0.002;
+	int stealFadeSamples = 88;
+	int stealFadeRemaining = 0;
+	bool stealRequested = false;
+	PendingNote pendingNote;
+
+	// Pitch, in semitones from the played note, glides per chunk when tuning or the pitch wheel moves
+	static constexpr float pitchBendRange = 2.0f;
+	static constexpr double pitchGlideSeconds = 0.015;
+	std::array<SmoothedParameter, 2> pitchSmoothers;
+	float noteFrequency = 440.0f;
+	float pitchBendSemitones = 0.0f;
+
+	// MPE expression, smoothed and applied once per chunk
+	static constexpr float mpeNotePitchBendRange = 48.0f;
+	static constexpr float pressureDepth = 0.5f; // No pressure plays 6 dB down, full pressure at unity
+	static constexpr int slideController = 74;
+	static constexpr double expressionSmoothingSeconds = 0.01;
+	bool mpeMode = false;
+	float masterPitchBendSemitones = 0.0f;
+	juce::SmoothedValue<float> pressureSmoother;
+	juce::SmoothedValue<float> slideSmoother{ 0.5f };
+
+	// Modulation, with pitch and detune applied once per chunk and level and pan per sample
+	ModulationMatrix modulation;
+	int renderPosition = 0; // Samples since the start of the current render
+	int renderLength = 0;
+	float pitchModulation = 0.0f;
+	float detuneModulation = 0.0f;
+
+	// Filter envelope, rendered for the synth's filter bank rather than applied here
+	const Envelope::Coefficients& filterEnvelopeCoefficients;
+	Envelope::State filterEnvelopeState;
+	std::vector<float> filterEnvelope;
+
+	// Set by prepareChunk for the rest of the chunk
+	std::array<bool, numOscillators> renderingOscillators{};
+	int numActiveOscillators = 0;
+	float oscillatorGain = 0.0f;
+
+	void beginNote(int midiNoteNumber, float velocity, int currentPitchWheelPosition)
+	{
+		// Reset envelopes and oscillators (prevent phase issues)
+		envelopeStates = {};
+		for (auto& osc : oscillators)
+			osc.reset();
 
-			++startSample;
+		noteFrequency = PitchTable::getNoteFrequency(midiNoteNumber);
+		pitchWheelMoved(currentPitchWheelPosition);
+		pitchModulation = 0.0f;
+		detuneModulation = 0.0f;
+
+		updateOscillatorParameters();
+
+		// Unison starts where its parameters are
+		updateUnisonTargets();
+		for (size_t i = 0; i < oscillators.size(); ++i)
+		{
+			detuneSmoothers[i].setCurrentAndTargetValue(detuneSmoothers[i].getTargetValue());
+			unisonMixSmoothers[i].setCurrentAndTargetValue(unisonMixSmoothers[i].getTargetValue());
+			spreadSmoothers[i].setCurrentAndTargetValue(spreadSmoothers[i].getTargetValue());
+			applyUnison(i);
+		}
+
+		// Start the note at its pitch, only later tuning changes glide
+		updatePitchTargets();
+		for (size_t i = 0; i < oscillators.size(); ++i)
+		{
+			pitchSmoothers[i].setCurrentAndTargetValue(pitchSmoothers[i].getTargetValue());
+			applyPitch(i);
+		}
+
+		// Level and pan also start where the parameters are
+		updateMixTargets();
+		for (size_t i = 0; i < levelSmoothers.size(); ++i)
+		{
+			levelSmoothers[i].setCurrentAndTargetValue(levelSmoothers[i].getTargetValue());
+			panSmoothers[i].setCurrentAndTargetValue(panSmoothers[i].getTargetValue());
+			PanTable::getGains(panSmoothers[i].getCurrentValue(), panGainsLeft[i], panGainsRight[i]);
 		}
+
+		noteVelocity = velocity;
+		modulation.startNote();
+		envelopeLevels = { 0.0f, 0.0f };
+		noteReleased = false;
+		for (size_t i = 0; i < envelopeStates.size(); ++i)
+			Envelope::start(envelopeCoefficients[i], envelopeStates[i]);
+
+		filterEnvelopeState = {};
+		Envelope::start(filterEnvelopeCoefficients, filterEnvelopeState);
 	}
 
-	void stopNote(float /*velocity*/, bool allowTailOff) override
+	// Renders one chunk of the grid entirely in the voice, splitting it where a steal fade ends
+	void renderGridChunk(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 	{
-		osc1_adsr.noteOff();
-		osc2_adsr.noteOff();
+		// Finish fading out a stolen note before starting the pending one
+		while (stealFadeRemaining > 0 && numSamples > 0)
+		{
+			int numThisTime = juce::jmin(numSamples, stealFadeRemaining);
+			renderChunk(numThisTime);
+
+			for (int i = 0; i < numThisTime; ++i)
+				envelopeBuffer[i] = static_cast<float>(stealFadeRemaining - i) / static_cast<float>(stealFadeSamples);
+
+			juce::FloatVectorOperations::multiply(voiceLeft.data(), envelopeBuffer.data(), numThisTime);
+			juce::FloatVectorOperations::multiply(voiceRight.data(), envelopeBuffer.data(), numThisTime);
+			writeChunk(outputBuffer, startSample, numThisTime);
+
+			renderPosition += numThisTime;
+			stealFadeRemaining -= numThisTime;
+			startSample += numThisTime;
+			numSamples -= numThisTime;
 
-		if (!allowTailOff || !osc1_adsr.isActive() && !osc2_adsr.isActive())
+			if (stealFadeRemaining == 0)
+			{
+				beginNote(pendingNote.midiNoteNumber, pendingNote.velocity, pendingNote.pitchWheelPosition);
+
+				if (pendingNote.released)
+					stopNote(0.0f, true);
+			}
+		}
+
+		if (numSamples == 0)
+			return;
+
+		// Free the voice as soon as its tail is inaudible, rather than rendering silence to the end of the release
+		if (isTailSilent())
+		{
+			holdFilterEnvelope(renderLength - renderPosition);
 			clearCurrentNote();
+			return;
+		}
+
+		renderChunk(numSamples);
+		writeChunk(outputBuffer, startSample, numSamples);
+		renderPosition += numSamples;
 	}
 
-	void pitchWheelMoved(int /*newValue*/) override {}
-	void controllerMoved(int /*controllerNumber*/, int /*newValue*/) override {}
+	// Renders both oscillators into voiceLeft and voiceRight
+	void renderChunk(int numSamples)
+	{
+		prepareChunk(numSamples);
 
-private:
-	std::array<Oscillator, 2> oscillators;
-	std::array<float, 2> oscLevels = { 0.0f, 0.0f };
-	std::array<juce::String, 5> oscWaveforms = { "Sine", "Square", "Saw", "Triangle", "Noise" };
-
-	// Oscillator 1 parameters
-	juce::ADSR osc1_adsr;
-	juce::ADSR::Parameters osc1_adsrParams;
-	std::atomic<float>* osc1_active = nullptr;
-	std::atomic<float>* osc1_waveform = nullptr;
-	std::atomic<float>* osc1_octave = nullptr;
-	std::atomic<float>* osc1_semitone = nullptr;
-	std::atomic<float>* osc1_fine = nullptr;
-	std::atomic<float>* osc1_attack = nullptr;
-	std::atomic<float>* osc1_decay = nullptr;
-	std::atomic<float>* osc1_sustain = nullptr;
-	std::atomic<float>* osc1_release = nullptr;
-	std::atomic<float>* osc1_voices = nullptr;
-	std::atomic<float>* osc1_voicesDetune = nullptr;
-	std::atomic<float>* osc1_voicesMix = nullptr;
-	std::atomic<float>* osc1_voicesPan = nullptr;
-	std::atomic<float>* osc1_level = nullptr;
-	std::atomic<float>* osc1_pan = nullptr;
-
-	// Oscillator 2 parameters
-	juce::ADSR osc2_adsr;
-	juce::ADSR::Parameters osc2_adsrParams;
-	std::atomic<float>* osc2_active = nullptr;
-	std::atomic<float>* osc2_waveform = nullptr;
-	std::atomic<float>* osc2_octave = nullptr;
-	std::atomic<float>* osc2_semitone = nullptr;
-	std::atomic<float>* osc2_fine = nullptr;
-	std::atomic<float>* osc2_attack = nullptr;
-	std::atomic<float>* osc2_decay = nullptr;
-	std::atomic<float>* osc2_sustain = nullptr;
-	std::atomic<float>* osc2_release = nullptr;
-	std::atomic<float>* osc2_voices = nullptr;
-	std::atomic<float>* osc2_voicesDetune = nullptr;
-	std::atomic<float>* osc2_voicesMix = nullptr;
-	std::atomic<float>* osc2_voicesPan = nullptr;
-	std::atomic<float>* osc2_level = nullptr;
-	std::atomic<float>* osc2_pan = nullptr;
-
-	void updateOscillatorParameters(double frequency)
-	{
-		// Oscillator 1 parameters
-		oscillators[0].setWaveform(juce::String(oscWaveforms[*osc1_waveform]));
-		oscillators[0].setFrequency(frequency, getSampleRate());
-		oscillators[0].setActive(*osc1_active);
-
-		// Oscillator 2 parameters
-		oscillators[1].setWaveform(juce::String(oscWaveforms[*osc2_waveform]));
-		oscillators[1].setFrequency(frequency, getSampleRate());
-		oscillators[1].setActive(*osc2_active);
-	}
-
-	void updateEnvelopeParameters()
-	{
-		osc1_adsrParams.attack = *osc1_attack;
-		osc1_adsrParams.decay = *osc1_decay;
-		osc1_adsrParams.sustain = *osc1_sustain;
-		osc1_adsrParams.release = *osc1_release;
-		osc1_adsr.setParameters(osc1_adsrParams);
-
-		osc2_adsrParams.attack = *osc2_attack;
-		osc2_adsrParams.decay = *osc2_decay;
-		osc2_adsrParams.sustain = *osc2_sustain;
-		osc2_adsrParams.release = *osc2_release;
-		osc2_adsr.setParameters(osc2_adsrParams);
+		for (size_t i = 0; i < oscillators.size(); ++i)
+			if (renderingOscillators[i])
+				oscillators[i].process(oscLeft[i].data(), oscRight[i].data(), numSamples);
+
+		mixChunk(numSamples);
+	}
+
+	// Control work for a chunk, everything the oscillators need before they render
+	void prepareChunk(int numSamples)
+	{
+		juce::FloatVectorOperations::clear(voiceLeft.data(), numSamples);
+		juce::FloatVectorOperations::clear(voiceRight.data(), numSamples);
+
+		updateModulation(numSamples);
+		renderFilterEnvelope(numSamples);
+
+		bool osc1Active = oscillators[0].isActive();
+		bool osc2Active = oscillators[1].isActive();
+		numActiveOscillators = (osc1Active ? 1 : 0) + (osc2Active ? 1 : 0);
+
+		// Normalise the output according to power summation principle
+		float normalisation = numActiveOscillators > 0 ? 1.0f / std::sqrt(static_cast<float>(numActiveOscillators)) : 0.0f;
+		oscillatorGain = noteVelocity * normalisation;
+
+		// An oscillator whose envelope has finished adds nothing, so skip it for the whole chunk
+		for (size_t i = 0; i < oscillators.size(); ++i)
+		{
+			renderingOscillators[i] = oscillators[i].isActive() && isEnvelopeActive(i);
+
+			// Frequency only changes while the pitch is gliding, and then once per chunk
+			if (renderingOscillators[i] && pitchSmoothers[i].isSmoothing())
+			{
+				pitchSmoothers[i].skip(numSamples);
+				applyPitch(i);
+			}
+
+			// Likewise the unison lanes, while detune, mix or spread glide
+			if (renderingOscillators[i] && (detuneSmoothers[i].isSmoothing() || unisonMixSmoothers[i].isSmoothing() || spreadSmoothers[i].isSmoothing()))
+			{
+				detuneSmoothers[i].skip(numSamples);
+				unisonMixSmoothers[i].skip(numSamples);
+				spreadSmoothers[i].skip(numSamples);
+				applyUnison(i);
+			}
+		}
+	}
+
+	// Mixes the rendered oscillators into voiceLeft and voiceRight through their envelopes, level and pan
+	void mixChunk(int numSamples)
+	{
+		if (numActiveOscillators == 0)
+			return;
+
+		for (size_t i = 0; i < oscillators.size(); ++i)
+			if (renderingOscillators[i])
+				mixOscillator(i, oscillatorGain, numSamples);
+
+		applyExpression(numSamples);
+		applyModulation(numSamples);
+	}
+
+	// Pressure sets the voice's gain in MPE mode, ramped across the chunk so it never steps
+	void applyExpression(int numSamples)
+	{
+		slideSmoother.skip(numSamples);
+
+		if (!mpeMode)
+			return;
+
+		float startGain = 1.0f - pressureDepth + pressureDepth * pressureSmoother.getCurrentValue();
+		pressureSmoother.skip(numSamples);
+		float endGain = 1.0f - pressureDepth + pressureDepth * pressureSmoother.getCurrentValue();
+
+		if (startGain == endGain)
+		{
+			juce::FloatVectorOperations::multiply(voiceLeft.data(), startGain, numSamples);
+			juce::FloatVectorOperations::multiply(voiceRight.data(), startGain, numSamples);
+			return;
+		}
+
+		float step = (endGain - startGain) / static_cast<float>(numSamples);
+
+		for (int i = 0; i < numSamples; ++i)
+			envelopeBuffer[static_cast<size_t>(i)] = startGain + step * static_cast<float>(i + 1);
+
+		juce::FloatVectorOperations::multiply(voiceLeft.data(), envelopeBuffer.data(), numSamples);
+		juce::FloatVectorOperations::multiply(voiceRight.data(), envelopeBuffer.data(), numSamples);
+	}
+
+	bool isFilterEnvelopeNeeded(int numSamples) const
+	{
+		return parameters.get(ParameterRegistry::filterType) >= 1.0f
+			&& renderPosition + numSamples <= static_cast<int>(filterEnvelope.size());
+	}
+
+	void renderFilterEnvelope(int numSamples)
+	{
+		if (isFilterEnvelopeNeeded(numSamples))
+			Envelope::render(filterEnvelopeCoefficients, filterEnvelopeState, filterEnvelope.data() + renderPosition, numSamples);
+	}
+
+	// Holds the filter envelope's last level for the rest of the render, once the voice stops early
+	void holdFilterEnvelope(int numSamples)
+	{
+		if (isFilterEnvelopeNeeded(numSamples))
+			juce::FloatVectorOperations::fill(filterEnvelope.data() + renderPosition, filterEnvelopeState.level, numSamples);
+	}
+
+	// True once the note has been released and every active oscillator's envelope has ended or fallen
+	// below the silence threshold. A voice with no active oscillators never makes a sound at all.
+	bool isTailSilent() const
+	{
+		bool osc1Sounding = oscillators[0].isActive() && isEnvelopeActive(0);
+		bool osc2Sounding = oscillators[1].isActive() && isEnvelopeActive(1);
+
+		if (!osc1Sounding && !osc2Sounding)
+			return true;
+
+		if (!noteReleased)
+			return false;
+
+		return (!osc1Sounding || envelopeLevels[0] < silenceThreshold)
+			&& (!osc2Sounding || envelopeLevels[1] < silenceThreshold);
+	}
+
+	void writeChunk(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+	{
+		if (outputBuffer.getNumChannels() > 1)
+		{
+			outputBuffer.addFrom(0, startSample, voiceLeft.data(), numSamples);
+			outputBuffer.addFrom(1, startSample, voiceRight.data(), numSamples);
+		}
+		else
+		{
+			// Fold down to mono, adding once so parallel and serial renders sum identically
+			juce::FloatVectorOperations::add(voiceLeft.data(), voiceRight.data(), numSamples);
+			outputBuffer.addFrom(0, startSample, voiceLeft.data(), numSamples, 0.5f);
+		}
+	}
+
+	// Runs the matrix for the chunk from the voice's current source values
+	void updateModulation(int numSamples)
+	{
+		modulation.setSource(ModulationMatrix::envelope1, envelopeStates[0].level);
+		modulation.setSource(ModulationMatrix::envelope2, envelopeStates[1].level);
+		modulation.setSource(ModulationMatrix::velocity, noteVelocity);
+		modulation.setSource(ModulationMatrix::pressure, pressureSmoother.getCurrentValue());
+		modulation.setSource(ModulationMatrix::slide, slideSmoother.getCurrentValue());
+		modulation.process(renderPosition, numSamples);
+
+		// The oscillators take one frequency and detune per chunk, so these use the chunk's end value
+		float pitchTarget = modulation.isActive(ModulationMatrix::pitch)
+			? modulation.getValue(ModulationMatrix::pitch, numSamples) * ModulationMatrix::pitchRange : 0.0f;
+
+		if (pitchTarget != pitchModulation)
+		{
+			pitchModulation = pitchTarget;
+			for (size_t i = 0; i < oscillators.size(); ++i)
+				applyPitch(i);
+		}
+
+		float detuneTarget = modulation.isActive(ModulationMatrix::detune)
+			? modulation.getValue(ModulationMatrix::detune, numSamples) * ModulationMatrix::detuneRange : 0.0f;
+
+		if (detuneTarget != detuneModulation)
+		{
+			detuneModulation = detuneTarget;
+			for (size_t i = 0; i < oscillators.size(); ++i)
+				applyUnison(i);
+		}
+	}
+
+	// Level and pan modulation on the summed voice, skipped entirely when nothing is routed to them
+	void applyModulation(int numSamples)
+	{
+		if (modulation.isActive(ModulationMatrix::level))
+		{
+			juce::FloatVectorOperations::copy(rampBuffer.data(), modulation.getRamp(ModulationMatrix::level), numSamples);
+			juce::FloatVectorOperations::add(rampBuffer.data(), 1.0f, numSamples);
+			juce::FloatVectorOperations::max(rampBuffer.data(), rampBuffer.data(), 0.0f, numSamples);
+			juce::FloatVectorOperations::multiply(voiceLeft.data(), rampBuffer.data(), numSamples);
+			juce::FloatVectorOperations::multiply(voiceRight.data(), rampBuffer.data(), numSamples);
+		}
+
+		if (modulation.isActive(ModulationMatrix::pan))
+		{
+			const float* panRamp = modulation.getRamp(ModulationMatrix::pan);
+
+			for (size_t k = 0; k < static_cast<size_t>(numSamples); ++k)
+			{
+				float left, right;
+				PanTable::getGains(juce::jlimit(-1.0f, 1.0f, panRamp[k]), left, right);
+				voiceLeft[k] *= left;
+				voiceRight[k] *= right;
+			}
+		}
+	}
+
+	float getParameter(size_t index, ParameterRegistry::OscillatorParameter parameter) const
+	{
+		return parameters.get(static_cast<int>(index), parameter);
+	}
+
+	void updateOscillatorParameters()
+	{
+		for (size_t i = 0; i < oscillators.size(); ++i)
+		{
+			oscillators[i].setWaveform(static_cast<int>(getParameter(i, ParameterRegistry::waveform)));
+			oscillators[i].setActive(getParameter(i, ParameterRegistry::active) >= 0.5f);
+		}
+	}
+
+	void updatePitchTargets()
+	{
+		float bend = pitchBendSemitones + masterPitchBendSemitones;
+		for (size_t i = 0; i < pitchSmoothers.size(); ++i)
+		{
+			pitchSmoothers[i].setTargetValue(getParameter(i, ParameterRegistry::octave) * 12.0f
+				+ getParameter(i, ParameterRegistry::semitone)
+				+ getParameter(i, ParameterRegistry::fine) / 100.0f + bend);
+		}
+	}
+
+	void applyPitch(size_t index)
+	{
+		float ratio = PitchTable::getRatio(pitchSmoothers[index].getCurrentValue() + pitchModulation);
+		oscillators[index].setFrequency(noteFrequency * ratio, getSampleRate());
+	}
+
+	bool isEnvelopeActive(size_t index) const
+	{
+		return envelopeStates[index].stage != Envelope::idle;
+	}
+
+	void mixOscillator(size_t index, float gain, int numSamples)
+	{
+		float* left = oscLeft[index].data();
+		float* right = oscRight[index].data();
+
+		Envelope::render(envelopeCoefficients[index], envelopeStates[index], envelopeBuffer.data(), numSamples);
+
+		// Level is folded into the envelope, as a ramp while it moves and a scalar otherwise
+		if (levelSmoothers[index].getNextRamp(rampBuffer.data(), numSamples))
+		{
+			juce::FloatVectorOperations::multiply(rampBuffer.data(), gain, numSamples);
+			juce::FloatVectorOperations::multiply(envelopeBuffer.data(), rampBuffer.data(), numSamples);
+		}
+		else
+		{
+			juce::FloatVectorOperations::multiply(envelopeBuffer.data(), levelSmoothers[index].getCurrentValue() * gain, numSamples);
+		}
+
+		envelopeLevels[index] = envelopeBuffer[static_cast<size_t>(numSamples - 1)];
+
+		// Envelope, then the oscillator's pan gains as it is mixed into the voice
+		juce::FloatVectorOperations::multiply(left, envelopeBuffer.data(), numSamples);
+		juce::FloatVectorOperations::multiply(right, envelopeBuffer.data(), numSamples);
+
+		if (panSmoothers[index].getNextRamp(rampBuffer.data(), numSamples))
+		{
+			for (size_t k = 0; k < static_cast<size_t>(numSamples); ++k)
+			{
+				PanTable::getGains(rampBuffer[k], panGainsLeft[index], panGainsRight[index]);
+				left[k] *= panGainsLeft[index];
+				right[k] *= panGainsRight[index];
+			}
+
+			juce::FloatVectorOperations::add(voiceLeft.data(), left, numSamples);
+			juce::FloatVectorOperations::add(voiceRight.data(), right, numSamples);
+		}
+		else
+		{
+			juce::FloatVectorOperations::addWithMultiply(voiceLeft.data(), left, panGainsLeft[index], numSamples);
+			juce::FloatVectorOperations::addWithMultiply(voiceRight.data(), right, panGainsRight[index], numSamples);
+		}
+	}
+
+	void updateMixTargets()
+	{
+		for (size_t i = 0; i < levelSmoothers.size(); ++i)
+		{
+			levelSmoothers[i].setTargetValue(getParameter(i, ParameterRegistry::level));
+			panSmoothers[i].setTargetValue(getParameter(i, ParameterRegistry::pan));
+		}
+	}
+
+	void updateUnisonTargets()
+	{
+		for (size_t i = 0; i < oscillators.size(); ++i)
+		{
+			detuneSmoothers[i].setTargetValue(getParameter(i, ParameterRegistry::voicesDetune));
+			unisonMixSmoothers[i].setTargetValue(getParameter(i, ParameterRegistry::voicesMix));
+			spreadSmoothers[i].setTargetValue(getParameter(i, ParameterRegistry::voicesPan));
+		}
+	}
+
+	// The lane count follows its parameter straight away, the rest at their smoothed values
+	void applyUnison(size_t index)
+	{
+		float detune = detuneSmoothers[index].getCurrentValue() + detuneModulation;
+		oscillators[index].setUnison(static_cast<int>(getParameter(index, ParameterRegistry::voices)),
+			juce::jlimit(-ModulationMatrix::detuneRange, ModulationMatrix::detuneRange, detune),
+			unisonMixSmoothers[index].getCurrentValue(),
+			spreadSmoothers[index].getCurrentValue());
 	}
 };
\ No newline at end of file
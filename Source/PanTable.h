@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    PanTable.h
+    Created: 17 Oct 2026 9:58:14pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Constant power pan law from a lookup table, so panning never calls sin or cos on the audio thread.
+// Gains are scaled by sqrt(2) so a centred signal passes at unity on each side.
+class PanTable
+{
+public:
+	static constexpr int tableSize = 256;
+
+	// Left and right gains for a pan position from -1 (left) to 1 (right)
+	static void getGains(float pan, float& left, float& right)
+	{
+		float position = (juce::jlimit(-1.0f, 1.0f, pan) + 1.0f) * 0.5f * static_cast<float>(tableSize);
+		int index = juce::jmin(static_cast<int>(position), tableSize - 1);
+		float fraction = position - static_cast<float>(index);
+
+		const auto& t = tables;
+		auto i = static_cast<size_t>(index);
+		left = t.left[i] + fraction * (t.left[i + 1] - t.left[i]);
+		right = t.right[i] + fraction * (t.right[i + 1] - t.right[i]);
+	}
+
+private:
+	struct Tables
+	{
+		Tables()
+		{
+			for (int i = 0; i <= tableSize; ++i)
+			{
+				float angle = static_cast<float>(i) / static_cast<float>(tableSize) * juce::MathConstants<float>::halfPi;
+				left[static_cast<size_t>(i)] = std::cos(angle) * juce::MathConstants<float>::sqrt2;
+				right[static_cast<size_t>(i)] = std::sin(angle) * juce::MathConstants<float>::sqrt2;
+			}
+		}
+
+		std::array<float, tableSize + 1> left;
+		std::array<float, tableSize + 1> right;
+	};
+
+	// Built at load time, the same way as PitchTable's
+	static inline const Tables tables{};
+};
\ No newline at end of file
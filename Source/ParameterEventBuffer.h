@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    ParameterEventBuffer.h
+    Created: 18 Oct 2026 12:52:17am
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Timestamped parameter changes for one block, the automation counterpart of a juce::MidiBuffer.
+// Changes are kept in time order and handed to the listener by the scheduler as the render reaches
+// them, so a ramp lands where the host drew it rather than on the block boundary.
+// Fixed capacity and audio thread only, nothing here allocates.
+class ParameterEventBuffer
+{
+public:
+	static constexpr int maxEvents = 1024;
+
+	struct Event
+	{
+		int samplePosition = 0;
+		int parameterIndex = 0;
+		float value = 0.0f;
+	};
+
+	class Listener
+	{
+	public:
+		virtual ~Listener() = default;
+
+		// Called on the audio thread, between sub-blocks
+		virtual void parameterEventReached(int parameterIndex, float value) = 0;
+	};
+
+	void setListener(Listener* newListener)
+	{
+		listener = newListener;
+	}
+
+	// Inserts after any change at the same sample, so changes at one position keep their order.
+	// Returns false and drops the change when the buffer is full.
+	bool addEvent(int parameterIndex, float value, int samplePosition)
+	{
+		if (numEvents == maxEvents)
+		{
+			jassertfalse;
+			return false;
+		}
+
+		// Hosts send changes in time order, so this rarely moves anything
+		int i = numEvents;
+		while (i > 0 && events[static_cast<size_t>(i - 1)].samplePosition > samplePosition)
+		{
+			events[static_cast<size_t>(i)] = events[static_cast<size_t>(i - 1)];
+			--i;
+		}
+
+		events[static_cast<size_t>(i)] = { samplePosition, parameterIndex, value };
+		++numEvents;
+		return true;
+	}
+
+	void clear()
+	{
+		numEvents = 0;
+	}
+
+	bool isEmpty() const
+	{
+		return numEvents == 0;
+	}
+
+	int getNumEvents() const
+	{
+		return numEvents;
+	}
+
+	const Event& getEvent(int index) const
+	{
+		return events[static_cast<size_t>(index)];
+	}
+
+	const Event* begin() const
+	{
+		return events.data();
+	}
+
+	const Event* end() const
+	{
+		return events.data() + numEvents;
+	}
+
+	// Moves every change to the same point of a render at factor times the sample rate
+	void scalePositions(int factor)
+	{
+		for (int i = 0; i < numEvents; ++i)
+			events[static_cast<size_t>(i)].samplePosition *= factor;
+	}
+
+	// Hands a change to the listener, called by the scheduler when the render reaches it
+	void apply(const Event& event) const
+	{
+		if (listener != nullptr)
+			listener->parameterEventReached(event.parameterIndex, event.value);
+	}
+
+private:
+	std::array<Event, maxEvents> events{};
+	int numEvents = 0;
+	Listener* listener = nullptr;
+};
+
+// Parameter changes made on the message thread, such as editor gestures, stamped with the time they
+// arrived so the next block can place them where they happened rather than all at its start.
+// Like juce::MidiMessageCollector, the changes that arrived since the last block are spread across
+// the next one, at the cost of one block of latency. One producer thread and one consumer thread.
+class ParameterChangeQueue
+{
+public:
+	static constexpr int capacity = 256;
+
+	// Message thread. Returns false and drops the change when the queue is full, the parameter's atomic
+	// still carries it to the next block.
+	bool push(int parameterIndex, float value)
+	{
+		auto scope = fifo.write(1);
+
+		if (scope.blockSize1 == 0)
+			return false;
+
+		changes[static_cast<size_t>(scope.startIndex1)] = { juce::Time::getMillisecondCounterHiRes(), parameterIndex, value };
+		return true;
+	}
+
+	// Audio thread. Adds every waiting change to events, positioned within a block of numSamples by
+	// when it arrived since the previous call.
+	void popInto(ParameterEventBuffer& events, int numSamples)
+	{
+		double now = juce::Time::getMillisecondCounterHiRes();
+		double elapsed = lastBlockTime > 0.0 ? now - lastBlockTime : 0.0; // Nothing to spread over before the first block
+		lastBlockTime = now;
+
+		auto scope = fifo.read(fifo.getNumReady());
+		scope.forEach([&](int index)
+		{
+			const auto& change = changes[static_cast<size_t>(index)];
+			int position = 0;
+
+			if (elapsed > 0.0)
+				position = static_cast<int>((change.time - (now - elapsed)) / elapsed * numSamples);
+
+			events.addEvent(change.parameterIndex, change.value, juce::jlimit(0, juce::jmax(0, numSamples - 1), position));
+		});
+	}
+
+	// From prepareToPlay, while the audio thread is stopped. Drops any changes still waiting, since
+	// their values already reach the next block through the parameters' atomics, and forgets the last
+	// block's time, which no longer means anything.
+	void reset()
+	{
+		auto scope = fifo.read(fifo.getNumReady()); // Finishes the read as it goes out of scope
+		lastBlockTime = 0.0;
+	}
+
+private:
+	struct Change
+	{
+		double time = 0.0;
+		int parameterIndex = 0;
+		float value = 0.0f;
+	};
+
+	juce::AbstractFifo fifo{ capacity };
+	std::array<Change, capacity> changes{};
+	double lastBlockTime = 0.0;
+};
\ No newline at end of file
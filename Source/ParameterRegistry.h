@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    ParameterRegistry.h
+    Created: 18 Oct 2026 1:18:40am
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Every plugin parameter in one constexpr table.
+// A parameter's index is fixed by the enums below, and the layout adds parameters in index order, so
+// the index is also its position in the processor's parameter list. The layout, the parameter
+// snapshot and change dispatch all work from the index, and nothing on the audio thread compares IDs.
+struct ParameterRegistry
+{
+	static constexpr int numOscillators = 2;
+	static constexpr int maxVoices = 16;
+	static constexpr int numModulationRoutes = 4;
+
+	enum GlobalParameter : int
+	{
+		gain = 0,
+		voiceLimit,
+		voiceLfoRate,
+		globalLfoRate,
+
+		// Each modulation route is a source, a target and a depth, in that order
+		modulation1Source,
+		modulation1Target,
+		modulation1Depth,
+		modulation2Source,
+		modulation2Target,
+		modulation2Depth,
+		modulation3Source,
+		modulation3Target,
+		modulation3Depth,
+		modulation4Source,
+		modulation4Target,
+		modulation4Depth,
+
+		// Filter on every voice, with its own envelope
+		filterType,
+		filterCutoff,
+		filterResonance,
+		filterEnvelopeAmount,
+		filterAttack,
+		filterDecay,
+		filterSustain,
+		filterRelease,
+
+		// Master effects, in the order they run
+		chorusEnabled,
+		chorusRate,
+		chorusDepth,
+		chorusMix,
+		delayEnabled,
+		delayTime,
+		delayFeedback,
+		delayMix,
+		reverbEnabled,
+		reverbSize,
+		reverbDamping,
+		reverbMix,
+
+		// Engine settings
+		renderThreads,
+		mpeEnabled,
+		oversampling,
+		numGlobalParameters
+	};
+
+	// Per-oscillator parameters, in the same order for each oscillator
+	enum OscillatorParameter : int
+	{
+		active = 0,
+		waveform,
+		octave,
+		semitone,
+		fine,
+		attack,
+		decay,
+		sustain,
+		release,
+		envelopeCurve,
+		voices,
+		voicesDetune,
+		voicesMix,
+		voicesPan,
+		level,
+		pan,
+		numOscillatorParameters
+	};
+
+	static constexpr int numParameters = numGlobalParameters + numOscillators * numOscillatorParameters;
+
+	enum class Type
+	{
+		floating,
+		integer,
+		boolean,
+		choice
+	};
+
+	enum class Choices
+	{
+		none,
+		waveforms,
+		envelopeCurves,
+		modulationSources,
+		modulationTargets,
+		filterTypes,
+		oversamplingFactors
+	};
+
+	// What the processor does when a parameter changes, beyond the next snapshot picking it up
+	enum class Dispatch
+	{
+		none,
+		envelope,
+		voiceLimit,
+		modulation,
+		filter,
+		renderThreads,
+		oversampling
+	};
+
+	struct Spec
+	{
+		const char* id; // Oscillator IDs are prefixed "osc1_", "osc2_"
+		const char* name; // Oscillator names are prefixed "Osc 1 ", "Osc 2 "
+		Type type;
+		float minimum;
+		float maximum;
+		float interval;
+		float skew;
+		float defaultValue;
+		Choices choices;
+		Dispatch dispatch;
+	};
+
+	static constexpr std::array<Spec, numGlobalParameters> globalSpecs{ {
+		{ "gain", "Gain", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.6f, Choices::none, Dispatch::none },
+		{ "voices", "Voices", Type::integer, 1.0f, static_cast<float>(maxVoices), 1.0f, 1.0f, 4.0f, Choices::none, Dispatch::voiceLimit },
+		{ "lfo_voiceRate", "Voice LFO Rate", Type::floating, 0.01f, 20.0f, 0.01f, 0.3f, 2.0f, Choices::none, Dispatch::modulation },
+		{ "lfo_globalRate", "Global LFO Rate", Type::floating, 0.01f, 20.0f, 0.01f, 0.3f, 0.5f, Choices::none, Dispatch::modulation },
+		{ "mod1_source", "Mod 1 Source", Type::choice, 0.0f, 7.0f, 1.0f, 1.0f, 0.0f, Choices::modulationSources, Dispatch::modulation },
+		{ "mod1_target", "Mod 1 Target", Type::choice, 0.0f, 4.0f, 1.0f, 1.0f, 0.0f, Choices::modulationTargets, Dispatch::modulation },
+		{ "mod1_depth", "Mod 1 Depth", Type::floating, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::modulation },
+		{ "mod2_source", "Mod 2 Source", Type::choice, 0.0f, 7.0f, 1.0f, 1.0f, 0.0f, Choices::modulationSources, Dispatch::modulation },
+		{ "mod2_target", "Mod 2 Target", Type::choice, 0.0f, 4.0f, 1.0f, 1.0f, 0.0f, Choices::modulationTargets, Dispatch::modulation },
+		{ "mod2_depth", "Mod 2 Depth", Type::floating, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::modulation },
+		{ "mod3_source", "Mod 3 Source", Type::choice, 0.0f, 7.0f, 1.0f, 1.0f, 0.0f, Choices::modulationSources, Dispatch::modulation },
+		{ "mod3_target", "Mod 3 Target", Type::choice, 0.0f, 4.0f, 1.0f, 1.0f, 0.0f, Choices::modulationTargets, Dispatch::modulation },
+		{ "mod3_depth", "Mod 3 Depth", Type::floating, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::modulation },
+		{ "mod4_source", "Mod 4 Source", Type::choice, 0.0f, 7.0f, 1.0f, 1.0f, 0.0f, Choices::modulationSources, Dispatch::modulation },
+		{ "mod4_target", "Mod 4 Target", Type::choice, 0.0f, 4.0f, 1.0f, 1.0f, 0.0f, Choices::modulationTargets, Dispatch::modulation },
+		{ "mod4_depth", "Mod 4 Depth", Type::floating, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::modulation },
+		{ "filter_type", "Filter Type", Type::choice, 0.0f, 3.0f, 1.0f, 1.0f, 0.0f, Choices::filterTypes, Dispatch::filter },
+		{ "filter_cutoff", "Filter Cutoff", Type::floating, 20.0f, 20000.0f, 0.1f, 0.25f, 20000.0f, Choices::none, Dispatch::filter },
+		{ "filter_resonance", "Filter Resonance", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::filter },
+		{ "filter_envelopeAmount", "Filter Envelope Amount", Type::floating, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::filter },
+		{ "filter_attack", "Filter Attack", Type::floating, 0.001f, 5.0f, 0.001f, 0.5f, 0.01f, Choices::none, Dispatch::envelope },
+		{ "filter_decay", "Filter Decay", Type::floating, 0.001f, 5.0f, 0.001f, 0.5f, 0.5f, Choices::none, Dispatch::envelope },
+		{ "filter_sustain", "Filter Sustain", Type::floating, 0.0f, 1.0f, 0.01f, 1.0f, 0.0f, Choices::none, Dispatch::envelope },
+		{ "filter_release", "Filter Release", Type::floating, 0.001f, 5.0f, 0.001f, 0.5f, 0.1f, Choices::none, Dispatch::envelope },
+		{ "chorus_enabled", "Chorus", Type::boolean, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "chorus_rate", "Chorus Rate", Type::floating, 0.05f, 10.0f, 0.01f, 0.5f, 1.0f, Choices::none, Dispatch::none },
+		{ "chorus_depth", "Chorus Depth", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.25f, Choices::none, Dispatch::none },
+		{ "chorus_mix", "Chorus Mix", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.5f, Choices::none, Dispatch::none },
+		{ "delay_enabled", "Delay", Type::boolean, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "delay_time", "Delay Time", Type::floating, 0.01f, 2.0f, 0.001f, 0.5f, 0.35f, Choices::none, Dispatch::none },
+		{ "delay_feedback", "Delay Feedback", Type::floating, 0.0f, 0.95f, 0.0f, 1.0f, 0.35f, Choices::none, Dispatch::none },
+		{ "delay_mix", "Delay Mix", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.3f, Choices::none, Dispatch::none },
+		{ "reverb_enabled", "Reverb", Type::boolean, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "reverb_size", "Reverb Size", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.5f, Choices::none, Dispatch::none },
+		{ "reverb_damping", "Reverb Damping", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.5f, Choices::none, Dispatch::none },
+		{ "reverb_mix", "Reverb Mix", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.3f, Choices::none, Dispatch::none },
+		{ "renderThreads", "Render Threads", Type::integer, 1.0f, 8.0f, 1.0f, 1.0f, 1.0f, Choices::none, Dispatch::renderThreads },
+		{ "mpe", "MPE", Type::boolean, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "oversampling", "Oversampling", Type::choice, 0.0f, 2.0f, 1.0f, 1.0f, 0.0f, Choices::oversamplingFactors, Dispatch::oversampling }
+	} };
+
+	static constexpr std::array<Spec, numOscillatorParameters> oscillatorSpecs{ {
+		{ "active", "Active", Type::boolean, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, Choices::none, Dispatch::none },
+		{ "waveform", "Waveform", Type::choice, 0.0f, 4.0f, 1.0f, 1.0f, 0.0f, Choices::waveforms, Dispatch::none },
+		{ "octave", "Octave", Type::integer, -3.0f, 3.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "semitone", "Semitone", Type::integer, -11.0f, 11.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "fine", "Fine", Type::integer, -100.0f, 100.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "attack", "Attack", Type::floating, 0.001f, 5.0f, 0.001f, 0.5f, 0.5f, Choices::none, Dispatch::envelope },
+		{ "decay", "Decay", Type::floating, 0.001f, 5.0f, 0.001f, 0.5f, 1.0f, Choices::none, Dispatch::envelope },
+		{ "sustain", "Sustain", Type::floating, 0.0f, 1.0f, 0.01f, 1.0f, 1.0f, Choices::none, Dispatch::envelope },
+		{ "release", "Release", Type::floating, 0.001f, 5.0f, 0.001f, 0.5f, 0.1f, Choices::none, Dispatch::envelope },
+		{ "envelopeCurve", "Envelope Curve", Type::choice, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, Choices::envelopeCurves, Dispatch::envelope },
+		{ "voices", "Voices", Type::integer, 1.0f, 16.0f, 1.0f, 1.0f, 1.0f, Choices::none, Dispatch::none },
+		{ "voicesDetune", "Voices Detune", Type::integer, -100.0f, 100.0f, 1.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "voicesMix", "Voices Mix", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.5f, Choices::none, Dispatch::none },
+		{ "voicesPan", "Voices Pan", Type::floating, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::none },
+		{ "level", "Level", Type::floating, 0.0f, 1.0f, 0.0f, 1.0f, 0.6f, Choices::none, Dispatch::none },
+		{ "pan", "Pan", Type::floating, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, Choices::none, Dispatch::none }
+	} };
+
+	// A missing entry would leave a null ID at the end of its table
+	static_assert(globalSpecs.back().id != nullptr, "Every global parameter needs a spec");
+	static_assert(oscillatorSpecs.back().id != nullptr, "Every oscillator parameter needs a spec");
+
+	static constexpr int getIndex(GlobalParameter parameter)
+	{
+		return parameter;
+	}
+
+	static constexpr int getIndex(int oscillator, OscillatorParameter parameter)
+	{
+		return numGlobalParameters + oscillator * numOscillatorParameters + parameter;
+	}
+
+	// Index of a modulation route's source, followed by its target and depth
+	static constexpr int getModulationIndex(int route)
+	{
+		return getIndex(modulation1Source) + route * (modulation2Source - modulation1Source);
+	}
+
+	// Oscillator a parameter belongs to, or -1 for global parameters
+	static constexpr int getOscillator(int index)
+	{
+		return index < numGlobalParameters ? -1 : (index - numGlobalParameters) / numOscillatorParameters;
+	}
+
+	static constexpr const Spec& getSpec(int index)
+	{
+		return index < numGlobalParameters
+			? globalSpecs[static_cast<size_t>(index)]
+			: oscillatorSpecs[static_cast<size_t>((index - numGlobalParameters) % numOscillatorParameters)];
+	}
+
+	// Parameter ID, such as "gain" or "osc2_level". Allocates, so not for the audio thread
+	static juce::String getParameterId(int index)
+	{
+		int oscillator = getOscillator(index);
+
+		if (oscillator < 0)
+			return getSpec(index).id;
+
+		return "osc" + juce::String(oscillator + 1) + "_" + getSpec(index).id;
+	}
+
+	// Display name, such as "Gain" or "Osc 2 Level". Allocates, so not for the audio thread
+	static juce::String getParameterName(int index)
+	{
+		int oscillator = getOscillator(index);
+
+		if (oscillator < 0)
+			return getSpec(index).name;
+
+		return "Osc " + juce::String(oscillator + 1) + " " + getSpec(index).name;
+	}
+
+	static juce::StringArray getChoiceNames(Choices choices)
+	{
+		switch (choices)
+		{
+			case Choices::waveforms:
+				return { "Sine", "Square", "Saw", "Triangle", "Noise" };
+			case Choices::envelopeCurves:
+				return { "Linear", "Exponential" };
+			case Choices::modulationSources:
+				return { "Off", "Voice LFO", "Global LFO", "Osc 1 Envelope", "Osc 2 Envelope", "Velocity", "Pressure", "Slide" };
+			case Choices::modulationTargets:
+				return { "Off", "Pitch", "Level", "Pan", "Detune" };
+			case Choices::filterTypes:
+				return { "Off", "Low Pass", "Band Pass", "High Pass" };
+			case Choices::oversamplingFactors:
+				return { "1x", "2x", "4x" };
+			default:
+				return {};
+		}
+	}
+
+	// Dispatch kind for every index, so change handling is one table lookup and a switch
+	static constexpr std::array<Dispatch, numParameters> createDispatchTable()
+	{
+		std::array<Dispatch, numParameters> table{};
+
+		for (int i = 0; i < numParameters; ++i)
+			table[static_cast<size_t>(i)] = getSpec(i).dispatch;
+
+		return table;
+	}
+
+	static const std::array<Dispatch, numParameters> dispatchTable;
+};
+
+inline constexpr std::array<ParameterRegistry::Dispatch, ParameterRegistry::numParameters> ParameterRegistry::dispatchTable
+	= ParameterRegistry::createDispatchTable();
\ No newline at end of file
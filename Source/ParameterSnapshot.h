@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Created: 17 Oct 2026 11:47:09pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterRegistry.h"
+
+// Every parameter's value for one block, read once at the top of processBlock and shared by const
+// reference with the voices. Values are indexed by ParameterRegistry's enums, so the audio thread never
+// looks a parameter up by ID, and every voice sees the same values for the whole block.
+struct ParameterSnapshot
+{
+	float get(ParameterRegistry::GlobalParameter parameter) const
+	{
+		return values[static_cast<size_t>(ParameterRegistry::getIndex(parameter))];
+	}
+
+	float get(int oscillator, ParameterRegistry::OscillatorParameter parameter) const
+	{
+		return values[static_cast<size_t>(ParameterRegistry::getIndex(oscillator, parameter))];
+	}
+
+	std::array<float, ParameterRegistry::numParameters> values{};
+
+	// Fills snapshots from a value tree state's parameter atomics
+	class Reader
+	{
+	public:
+		// Call once, on the message thread, after the value tree state has been created
+		void attach(juce::AudioProcessorValueTreeState& apvts)
+		{
+			for (int i = 0; i < ParameterRegistry::numParameters; ++i)
+			{
+				sources[static_cast<size_t>(i)] = apvts.getRawParameterValue(ParameterRegistry::getParameterId(i));
+				jassert(sources[static_cast<size_t>(i)] != nullptr);
+			}
+		}
+
+		void read(ParameterSnapshot& snapshot) const
+		{
+			for (size_t i = 0; i < sources.size(); ++i)
+				snapshot.values[i] = sources[i]->load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::array<std::atomic<float>*, ParameterRegistry::numParameters> sources{};
+	};
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    PitchTable.h
+    Created: 17 Oct 2026 5:26:03pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Precomputed pitch lookups so tuning never calls pow on the audio thread.
+// A ratio is split into a whole-semitone table and a one-cent table that is interpolated.
+class PitchTable
+{
+public:
+	static constexpr int maxSemitones = 64;
+
+	// Frequency ratio for an offset in semitones, clamped to +/- maxSemitones
+	static float getRatio(float semitones)
+	{
+		semitones = juce::jlimit(static_cast<float>(-maxSemitones), static_cast<float>(maxSemitones) - 0.01f, semitones);
+
+		// Whole semitones and cents both come from one whole number of cents, so the cent index stays
+		// within 0 to 99 even when rounding puts the fraction at exactly 1
+		float cents = semitones * 100.0f;
+		int totalCents = static_cast<int>(std::floor(cents));
+		int whole = (totalCents >= 0 ? totalCents : totalCents - 99) / 100;
+		int centIndex = totalCents - whole * 100;
+		float centFraction = cents - static_cast<float>(totalCents);
+
+		const auto& t = tables;
+		float centRatio = t.cents[static_cast<size_t>(centIndex)] + centFraction * (t.cents[static_cast<size_t>(centIndex + 1)] - t.cents[static_cast<size_t>(centIndex)]);
+
+		return t.semitones[static_cast<size_t>(whole + maxSemitones)] * centRatio;
+	}
+
+	static float getNoteFrequency(int midiNoteNumber)
+	{
+		return tables.notes[static_cast<size_t>(juce::jlimit(0, 127, midiNoteNumber))];
+	}
+
+private:
+	struct Tables
+	{
+		Tables()
+		{
+			for (int i = 0; i < static_cast<int>(semitones.size()); ++i)
+				semitones[static_cast<size_t>(i)] = std::pow(2.0f, static_cast<float>(i - maxSemitones) / 12.0f);
+
+			for (int i = 0; i < static_cast<int>(cents.size()); ++i)
+				cents[static_cast<size_t>(i)] = std::pow(2.0f, static_cast<float>(i) / 1200.0f);
+
+			for (int i = 0; i < static_cast<int>(notes.size()); ++i)
+				notes[static_cast<size_t>(i)] = static_cast<float>(juce::MidiMessage::getMidiNoteInHertz(i));
+		}
+
+		std::array<float, 2 * maxSemitones + 1> semitones;
+		std::array<float, 101> cents;
+		std::array<float, 128> notes;
+	};
+
+	// Filled when the plugin binary loads, never on the audio thread
+	static inline const Tables tables{};
+};
\ No newline at end of file
@@ -105,7 +105,7 @@ PocketsynthAudioProcessorEditor::PocketsynthAudioProcessorEditor (PocketsynthAud
 	osc1_label.setJustificationType(juce::Justification::centred);
 	addAndMakeVisible(osc1_label);
 	/*osc1waveform_comboBoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
-		audioProcessor.getTreeState(), "osc1waveform", osc1waveform_comboBox);*/
+		audioProcessor.getTreeState(), "osc1_waveform", osc1waveform_comboBox);*/
 	osc1waveform_comboBox.addItem("Sine", 1);
 	osc1waveform_comboBox.addItem("Square", 2);
 	osc1waveform_comboBox.addItem("Saw", 3);
@@ -116,7 +116,7 @@ PocketsynthAudioProcessorEditor::PocketsynthAudioProcessorEditor (PocketsynthAud
 		{
 			// Parameter value in APVTS expects normalised value between 0 and 1
 			if (auto* param = dynamic_cast<juce::AudioParameterChoice*>(
-				audioProcessor.getTreeState().getParameter("osc1waveform")))
+				audioProcessor.getTreeState().getParameter("osc1_waveform")))
 			{
 				param->setValueNotifyingHost(
 					static_cast<float>(osc1waveform_comboBox.getSelectedId() - 1) / (param->choices.size() - 1)
@@ -32,13 +32,13 @@ PocketsynthAudioProcessor::PocketsynthAudioProcessor()
 	licenseManager.addListener(this);
 
     // Add listeners to all parameters
+	jassert(getParameters().size() == ParameterRegistry::numParameters);
     for (auto p : getParameters())
-    {
-        if (auto* paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(p))
-        {
-			treeState.addParameterListener(paramWithID->paramID, this);
-        }
-    }
+		p->addListener(this);
+
+	parameterReader.attach(treeState);
+	parameterReader.read(parameters);
+	parameterEvents.setListener(this);
 
     setupSynth();
 }
@@ -47,27 +47,21 @@ PocketsynthAudioProcessor::~PocketsynthAudioProcessor()
 {
 	// Remove listeners
 	licenseManager.removeListener(this);
+	cancelPendingUpdate();
 
     for (auto p : getParameters())
-    {
-        if (auto* paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(p))
-        {
-            treeState.removeParameterListener(paramWithID->paramID, this);
-        }
-    }
+		p->removeListener(this);
 }
 
+// Creates every voice the synth can use, only the voice limit changes after this
 void PocketsynthAudioProcessor::setupSynth()
 {
-	int voices = static_cast<int>(*treeState.getRawParameterValue("voices"));
-
-	synth.clearVoices();
+	for (int i = 0; i < PocketSynthesiser::maxVoices; i++)
+		synth.addVoice(new OscillatorVoice(*wavetableBank, synth.getVoiceBank(), parameters, synth.getEnvelopeCoefficients(),
+			synth.getFilterEnvelopeCoefficients(), synth.getModulationRouting(), i));
 
-	for (int i = 0; i < voices; i++)
-		synth.addVoice(new OscillatorVoice());
-
-    if (synth.getNumSounds() == 0)
-    	synth.addSound(new OscillatorSound());
+	synth.addSound(new OscillatorSound());
+	synth.setVoiceLimit(static_cast<int>(parameters.get(ParameterRegistry::voiceLimit)));
 }
 
 // Set up the ValueTreeState with default values
@@ -75,71 +69,169 @@ juce::AudioProcessorValueTreeState::ParameterLayout PocketsynthAudioProcessor::c
 {
 	juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
-	// Global parameters
-	layout.add(std::make_unique<juce::AudioParameterFloat>("gain", "Gain", juce::NormalisableRange<float>(0.0f, 1.0f), initialGain));
-	layout.add(std::make_unique<juce::AudioParameterInt>("voices", "Voices", 1, 16, 4));
-
-    // Oscillator 1 parameters
-	layout.add(std::make_unique<juce::AudioParameterBool>("osc1_active", "Osc 1 Active", true));
-	layout.add(std::make_unique<juce::AudioParameterChoice>("osc1_waveform", "Osc 1 Waveform", juce::StringArray{ "Sine", "Square", "Saw", "Triangle", "Noise"}, 0));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc1_octave", "Osc 1 Octave", -3, 3, 0));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc1_semitone", "Osc 1 Semitone", -11, 11, 0));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc1_fine", "Osc 1 Fine", -100, 100, 0));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_attack", "Osc 1 Attack", juce::NormalisableRange<float>(0.001f, 5.0f, 0.001f, 0.5f), 0.5f));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_decay", "Osc 1 Decay", juce::NormalisableRange<float>(0.001f, 5.0f, 0.001f, 0.5f), 1.0f));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_sustain", "Osc 1 Sustain", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 1.0f));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_release", "Osc 1 Release", juce::NormalisableRange<float>(0.001f, 5.0f, 0.001f, 0.5f), 0.1f));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc1_voices", "Osc 1 Voices", 1, 16, 1));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc1_voicesDetune", "Osc 1 Voices Detune", -100, 100, 0));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_voicesMix", "Osc 1 Voices Mix", juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_voicesPan", "Osc 1 Voices Pan", juce::NormalisableRange<float>(-1.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_level", "Osc 1 Level", juce::NormalisableRange<float>(0.0f, 1.0f), 0.6f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc1_pan", "Osc 1 Pan", juce::NormalisableRange<float>(-1.0f, 1.0f), 0.0f));
-
-    // Oscillator 2 parameters
-    layout.add(std::make_unique<juce::AudioParameterBool>("osc2_active", "Osc 2 Active", true));
-	layout.add(std::make_unique<juce::AudioParameterChoice>("osc2_waveform", "Osc 2 Waveform", juce::StringArray{ "Sine", "Square", "Saw", "Triangle", "Noise" }, 0));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc2_octave", "Osc 2 Octave", -3, 3, 0));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc2_semitone", "Osc 2 Semitone", -11, 11, 0));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc2_fine", "Osc 2 Fine", -100, 100, 0));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_attack", "Osc 2 Attack", juce::NormalisableRange<float>(0.001f, 5.0f, 0.001f, 0.5f), 0.5f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_decay", "Osc 2 Decay", juce::NormalisableRange<float>(0.001f, 5.0f, 0.001f, 0.5f), 1.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_sustain", "Osc 2 Sustain", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 1.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_release", "Osc 2 Release", juce::NormalisableRange<float>(0.001f, 5.0f, 0.001f, 0.5f), 0.1f));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc2_voices", "Osc 2 Voices", 1, 16, 1));
-	layout.add(std::make_unique<juce::AudioParameterInt>("osc2_voicesDetune", "Osc 2 Voices Detune", -100, 100, 0));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_voicesMix", "Osc 2 Voices Mix", juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f));
-	layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_voicesPan", "Osc 2 Voices Pan", juce::NormalisableRange<float>(-1.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_level", "Osc 2 Level", juce::NormalisableRange<float>(0.0f, 1.0f), 0.6f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("osc2_pan", "Osc 2 Pan", juce::NormalisableRange<float>(-1.0f, 1.0f), 0.0f));
+	static_assert(ParameterRegistry::oscillatorSpecs[ParameterRegistry::voices].maximum == Oscillator::maxUnisonVoices,
+		"Unison voice range must match the oscillator");
+
+	// Parameters are added in registry order, so each one's index in the processor matches the registry
+	for (int i = 0; i < ParameterRegistry::numParameters; ++i)
+	{
+		const auto& spec = ParameterRegistry::getSpec(i);
+		auto id = ParameterRegistry::getParameterId(i);
+		auto name = ParameterRegistry::getParameterName(i);
+
+		switch (spec.type)
+		{
+			case ParameterRegistry::Type::boolean:
+				layout.add(std::make_unique<juce::AudioParameterBool>(id, name, spec.defaultValue >= 0.5f));
+				break;
+
+			case ParameterRegistry::Type::choice:
+				layout.add(std::make_unique<juce::AudioParameterChoice>(id, name,
+					ParameterRegistry::getChoiceNames(spec.choices), static_cast<int>(spec.defaultValue)));
+				break;
+
+			case ParameterRegistry::Type::integer:
+				layout.add(std::make_unique<juce::AudioParameterInt>(id, name,
+					static_cast<int>(spec.minimum), static_cast<int>(spec.maximum), static_cast<int>(spec.defaultValue)));
+				break;
+
+			case ParameterRegistry::Type::floating:
+				layout.add(std::make_unique<juce::AudioParameterFloat>(id, name,
+					juce::NormalisableRange<float>(spec.minimum, spec.maximum, spec.interval, spec.skew), spec.defaultValue));
+				break;
+		}
+	}
 
 	return layout;
 }
 
-// Listen for changes on the ValueTreeState
-void PocketsynthAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+// Listen for changes to any parameter. The index is the parameter's registry index, and newValue is normalised
+void PocketsynthAudioProcessor::parameterValueChanged(int parameterIndex, float newValue)
 {
-	if (parameterID == "gain")
+	// Host automation arrives on its own threads and is read from the atomics, only editor changes are queued
+	if (juce::MessageManager::existsAndIsCurrentThread())
 	{
-		// Set the gain of the synth
+		auto* parameter = static_cast<juce::RangedAudioParameter*>(getParameters()[parameterIndex]);
+		editorChanges.push(parameterIndex, parameter->convertFrom0to1(newValue));
 	}
 
-    if (parameterID == "voices")
-    {
-		setupSynth();
-    }
+	switch (ParameterRegistry::dispatchTable[static_cast<size_t>(parameterIndex)])
+	{
+		case ParameterRegistry::Dispatch::voiceLimit:
+		{
+			auto* parameter = static_cast<juce::RangedAudioParameter*>(getParameters()[parameterIndex]);
+			synth.setVoiceLimit(juce::roundToInt(parameter->convertFrom0to1(newValue)));
+			break;
+		}
 
-	if (parameterID == "osc1waveform")
-    {
-		// Set the waveform of oscillator 1
-		for (int i = 0; i < synth.getNumVoices(); i++)
+		// Changes can arrive on the audio thread, so the pool is resized later on the message thread
+		case ParameterRegistry::Dispatch::renderThreads:
 		{
-			if (auto* voice = dynamic_cast<OscillatorVoice*>(synth.getVoice(i)))
-			{
-				//voice->setWaveform(newValue);
-			}
+			auto* parameter = static_cast<juce::RangedAudioParameter*>(getParameters()[parameterIndex]);
+			requestedRenderThreads.store(juce::roundToInt(parameter->convertFrom0to1(newValue)));
+			triggerAsyncUpdate();
+			break;
 		}
-    }
+
+		case ParameterRegistry::Dispatch::oversampling:
+		{
+			auto* parameter = static_cast<juce::RangedAudioParameter*>(getParameters()[parameterIndex]);
+			requestedOversampling.store(juce::roundToInt(parameter->convertFrom0to1(newValue)));
+			triggerAsyncUpdate();
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void PocketsynthAudioProcessor::handleAsyncUpdate()
+{
+	int numThreads = requestedRenderThreads.load();
+	if (numThreads != synth.getNumRenderThreads())
+		synth.setNumRenderThreads(numThreads);
+
+	int factor = juce::jlimit(0, static_cast<int>(Oversampling::x4), requestedOversampling.load());
+	if (factor != oversampling.load())
+		setOversampling(static_cast<Oversampling>(factor));
+}
+
+bool PocketsynthAudioProcessor::haveEnvelopeParametersChanged() const
+{
+	for (size_t i = 0; i < appliedEnvelopeParameters.size(); ++i)
+		if (ParameterRegistry::dispatchTable[i] == ParameterRegistry::Dispatch::envelope && parameters.values[i] != appliedEnvelopeParameters[i])
+			return true;
+
+	return false;
+}
+
+// Recalculates the envelope coefficients shared by all voices, and the filter envelope
+void PocketsynthAudioProcessor::updateEnvelopeCoefficients()
+{
+	appliedEnvelopeParameters = parameters.values;
+
+	for (int i = 0; i < OscillatorVoice::numOscillators; ++i)
+	{
+		Envelope::Parameters envelope;
+		envelope.attack = parameters.get(i, ParameterRegistry::attack);
+		envelope.decay = parameters.get(i, ParameterRegistry::decay);
+		envelope.sustain = parameters.get(i, ParameterRegistry::sustain);
+		envelope.release = parameters.get(i, ParameterRegistry::release);
+		envelope.curve = static_cast<int>(parameters.get(i, ParameterRegistry::envelopeCurve));
+
+		synth.setEnvelopeParameters(i, envelope);
+	}
+
+	Envelope::Parameters filterEnvelope;
+	filterEnvelope.attack = parameters.get(ParameterRegistry::filterAttack);
+	filterEnvelope.decay = parameters.get(ParameterRegistry::filterDecay);
+	filterEnvelope.sustain = parameters.get(ParameterRegistry::filterSustain);
+	filterEnvelope.release = parameters.get(ParameterRegistry::filterRelease);
+	synth.setFilterEnvelopeParameters(filterEnvelope);
+}
+
+void PocketsynthAudioProcessor::setOversampling(Oversampling newOversampling)
+{
+	oversampling.store(static_cast<int>(newOversampling));
+
+	// The voices and oversampler are rebuilt for the new rate while the audio thread is held off
+	if (getSampleRate() > 0.0)
+	{
+		suspendProcessing(true);
+		prepareToPlay(getSampleRate(), getBlockSize());
+		suspendProcessing(false);
+	}
+}
+
+void PocketsynthAudioProcessor::addParameterEvent(int parameterIndex, float value, int samplePosition)
+{
+	jassert(parameterIndex >= 0 && parameterIndex < ParameterRegistry::numParameters);
+	parameterEvents.addEvent(parameterIndex, value, samplePosition);
+}
+
+// Called by the scheduler between sub-blocks, as the render reaches each timestamped change
+void PocketsynthAudioProcessor::parameterEventReached(int parameterIndex, float value)
+{
+	parameters.values[static_cast<size_t>(parameterIndex)] = value;
+
+	switch (ParameterRegistry::dispatchTable[static_cast<size_t>(parameterIndex)])
+	{
+		case ParameterRegistry::Dispatch::envelope:
+			updateEnvelopeCoefficients();
+			break;
+
+		case ParameterRegistry::Dispatch::modulation:
+			synth.updateModulation(parameters);
+			break;
+
+		case ParameterRegistry::Dispatch::filter:
+			synth.updateFilter(parameters);
+			break;
+
+		default:
+			break;
+	}
 }
 
 void PocketsynthAudioProcessor::savePreset()
@@ -289,9 +381,17 @@ bool PocketsynthAudioProcessor::isMidiEffect() const
    #endif
 }
 
+// The longest voice release plus however long the effects ring on after it
 double PocketsynthAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+	ParameterSnapshot current;
+	parameterReader.read(current);
+
+	double release = 0.0;
+	for (int i = 0; i < OscillatorVoice::numOscillators; ++i)
+		release = juce::jmax(release, static_cast<double>(current.get(i, ParameterRegistry::release)));
+
+	return release + EffectsChain::getTailLengthSeconds(current);
 }
 
 int PocketsynthAudioProcessor::getNumPrograms()
@@ -323,16 +423,61 @@ void PocketsynthAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-	synth.setCurrentPlaybackSampleRate(sampleRate);
+	int numChannels = juce::jmax(1, getTotalNumOutputChannels());
+
+	// Hosts switch to non-realtime before preparing for an offline bounce, so the factor is picked here
+	int factorLog2 = isNonRealtime() ? static_cast<int>(Oversampling::x4) : oversampling.load();
+	oversamplingFactor = 1 << factorLog2;
+
+	if (factorLog2 > 0)
+	{
+		// No integer latency compensation, its extra delay would be sized for the upsampler's latency too
+		oversampler = std::make_unique<juce::dsp::Oversampling<float>>(static_cast<size_t>(numChannels), static_cast<size_t>(factorLog2),
+			juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, false);
+		oversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
+
+		// The block processSamplesUp returns is the last stage's own buffer, the one processSamplesDown
+		// decimates from. It is allocated by initProcessing and never moves, so it is found once here
+		// and the voices render straight into it, without upsampling a silent block every time.
+		juce::AudioBuffer<float> silence(numChannels, samplesPerBlock);
+		silence.clear();
+		oversampledStorage = oversampler->processSamplesUp(juce::dsp::AudioBlock<float>(silence));
+		oversampler->reset();
+
+		oversampledMidi.ensureSize(4096);
+		setLatencySamples(juce::roundToInt(getDecimationLatency(factorLog2)));
+	}
+	else
+	{
+		oversampler.reset();
+		oversampledStorage = {};
+		setLatencySamples(0);
+	}
+
+	// Everything up to the decimation runs at the render rate, the effects and master gain at the host rate
+	double renderSampleRate = sampleRate * oversamplingFactor;
+	int renderBlockSize = samplesPerBlock * oversamplingFactor;
+
+	synth.setCurrentPlaybackSampleRate(renderSampleRate);
+	synth.prepare(renderBlockSize, getTotalNumOutputChannels());
+
+	// Build the shared wavetables once, before any voice reads them
+	wavetableBank->prepare();
+	parameterReader.read(parameters);
+	updateEnvelopeCoefficients();
+	editorChanges.reset();
+
+	float gain = parameters.get(ParameterRegistry::gain);
+	masterGain.reset(sampleRate, masterGainSmoothingSeconds);
+	masterGain.setCurrentAndTargetValue(gain * gain);
+
+	effects.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels());
 
     // Prepare each voice
     for (int i = 0; i < synth.getNumVoices(); i++)
     {
 		if (auto* voice = dynamic_cast<OscillatorVoice*>(synth.getVoice(i)))
-		{
-			voice->prepareToPlay(sampleRate, samplesPerBlock);
-			voice->setParameters(treeState);
-		}
+			voice->prepareToPlay(renderSampleRate, renderBlockSize);
     }
 }
 
@@ -384,25 +529,135 @@ void PocketsynthAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         buffer.clear (i, 0, buffer.getNumSamples());
 
 	midiKeyboardState.processNextMidiBuffer(midiMessages, 0, buffer.getNumSamples(), true);
-	synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    float gainModifier = static_cast<float>(*treeState.getRawParameterValue("gain"));
+	// Every voice reads this same snapshot, which only changes between sub-blocks when the block
+	// carries timestamped changes. Those parameters start where the last block left them.
+	editorChanges.popInto(parameterEvents, buffer.getNumSamples());
 
-    for (int channel = 0; channel < totalNumOutputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
+	if (parameterEvents.isEmpty())
+	{
+		parameterReader.read(parameters);
+	}
+	else
+	{
+		auto previous = parameters;
+		parameterReader.read(parameters);
 
-		for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-		{
-			channelData[sample] *= std::pow(gainModifier, 2); //Apply exponential gain curve to mimic human hearing
-		}
-    }
+		for (const auto& event : parameterEvents)
+			parameters.values[static_cast<size_t>(event.parameterIndex)] = previous.values[static_cast<size_t>(event.parameterIndex)];
+	}
+
+	if (haveEnvelopeParametersChanged())
+		updateEnvelopeCoefficients();
+
+	synth.updateModulation(parameters);
+	synth.updateFilter(parameters);
+
+	// Switching MPE resets the channel routing, so it is only done between renders
+	bool mpe = parameters.get(ParameterRegistry::mpeEnabled) >= 0.5f;
+	if (mpe != synth.isMpeEnabled())
+		synth.setMpeEnabled(mpe);
+
+	if (oversampler != nullptr)
+		renderOversampled(buffer, midiMessages);
+	else
+		renderVoices(buffer, midiMessages);
+
+	parameterEvents.clear();
+
+	effects.update(parameters);
+	effects.process(buffer, totalNumOutputChannels, buffer.getNumSamples());
+
+	applyMasterGain(buffer, totalNumOutputChannels);
+}
+
+// Renders the synth into the whole of buffer, at whatever rate it is prepared for
+void PocketsynthAudioProcessor::renderVoices(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages)
+{
+	synth.renderNextBlockScheduled(buffer, midiMessages, parameterEvents, 0, buffer.getNumSamples());
+}
+
+// Renders the voices into the oversampler's last stage buffer and decimates it back into buffer
+void PocketsynthAudioProcessor::renderOversampled(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages)
+{
+	juce::dsp::AudioBlock<float> block(buffer);
+	auto oversampledBlock = oversampledStorage.getSubBlock(0, block.getNumSamples() * static_cast<size_t>(oversamplingFactor));
+	oversampledBlock.clear();
+
+	auto numChannels = juce::jmin(oversampledChannels.size(), oversampledBlock.getNumChannels());
+	for (size_t channel = 0; channel < numChannels; ++channel)
+		oversampledChannels[channel] = oversampledBlock.getChannelPointer(channel);
+
+	juce::AudioBuffer<float> oversampledBuffer(oversampledChannels.data(), static_cast<int>(numChannels),
+		static_cast<int>(oversampledBlock.getNumSamples()));
+
+	// MIDI and parameter changes land at the same point of the longer render
+	oversampledMidi.clear();
+	for (const auto metadata : midiMessages)
+		oversampledMidi.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition * oversamplingFactor);
+
+	parameterEvents.scalePositions(oversamplingFactor);
+
+	renderVoices(oversampledBuffer, oversampledMidi);
+	oversampler->processSamplesDown(block);
+}
+
+// Latency of the decimation alone, in host samples. The voices render straight into the oversampled
+// block, so the upsampling filters, which juce::dsp::Oversampling counts in its own latency, are never
+// in the signal path. The stages are designed as juce::dsp::Oversampling does at max quality.
+double PocketsynthAudioProcessor::getDecimationLatency(int factorLog2)
+{
+	constexpr double frequency = 0.0001; // Phase delay just above DC, relative to each stage's rate
+	double latency = 0.0;
+	int order = 1;
+
+	for (int stage = 0; stage < factorLog2; ++stage)
+	{
+		float transitionWidth = 0.12f * (stage == 0 ? 0.5f : 1.0f);
+		float stopbandGain = -70.0f + 10.0f * static_cast<float>(stage);
+		auto structure = juce::dsp::FilterDesign<float>::designIIRLowpassHalfBandPolyphaseAllpassMethod(transitionWidth, stopbandGain);
+
+		// Both paths are all-pass, and near DC the half-band sum takes the mean of their phases
+		double phase = 0.0;
+		for (auto* coefficients : structure.directPath)
+			phase += coefficients->getPhaseForFrequency(frequency, 1.0);
+		for (auto* coefficients : structure.delayedPath)
+			phase += coefficients->getPhaseForFrequency(frequency, 1.0);
+
+		order *= 2;
+		latency += -0.5 * phase / (juce::MathConstants<double>::twoPi * frequency) / order;
+	}
+
+	return latency;
+}
+
+// Applies the master gain. A steady gain is one vector multiply per channel, a changing one ramps
+// from the last block's value a chunk at a time
+void PocketsynthAudioProcessor::applyMasterGain(juce::AudioBuffer<float>& buffer, int numChannels)
+{
+	// Squared to mimic human hearing, once per block rather than per sample
+	float gain = parameters.get(ParameterRegistry::gain);
+	masterGain.setTargetValue(gain * gain);
+
+	int numSamples = buffer.getNumSamples();
+
+	if (!masterGain.isSmoothing())
+	{
+		for (int channel = 0; channel < numChannels; ++channel)
+			juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel), masterGain.getTargetValue(), numSamples);
+		return;
+	}
+
+	for (int start = 0; start < numSamples; start += masterGainChunkSize)
+	{
+		int chunk = juce::jmin(masterGainChunkSize, numSamples - start);
+
+		for (int i = 0; i < chunk; ++i)
+			masterGainRamp[static_cast<size_t>(i)] = masterGain.getNextValue();
+
+		for (int channel = 0; channel < numChannels; ++channel)
+			juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, start), masterGainRamp.data(), chunk);
+	}
 }
 
 //==============================================================================
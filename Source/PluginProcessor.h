@@ -12,6 +12,11 @@
 #include "LicenseManager.h"
 #include "OscillatorSound.h"
 #include "OscillatorVoice.h"
+#include "WavetableBank.h"
+#include "PocketSynthesiser.h"
+#include "ParameterSnapshot.h"
+#include "ParameterEventBuffer.h"
+#include "EffectsChain.h"
 
 //==============================================================================
 /**
@@ -19,7 +24,9 @@
 class PocketsynthAudioProcessor  : public juce::AudioProcessor,
 	                               public LicenseManager::Listener,
 	                               public juce::ChangeBroadcaster,
-	                               public juce::AudioProcessorValueTreeState::Listener
+	                               public juce::AudioProcessorParameter::Listener,
+	                               private ParameterEventBuffer::Listener,
+	                               private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -76,12 +83,30 @@ public:
     void onLicenseActivated() override;
 	void onLicenseDeactivated() override;
 
-    // Initial values
-    static constexpr float initialGain = 0.6f;
-
 	// Midi management
 	juce::MidiKeyboardState& getMidiKeyboardState() { return midiKeyboardState; }
 
+	// Threads used to render voices, set by the renderThreads parameter. 1 renders everything on the host's audio thread
+	int getNumRenderThreads() const { return synth.getNumRenderThreads(); }
+
+	// MPE lower zone input, set by the mpe parameter
+	bool isMpeEnabled() const { return synth.isMpeEnabled(); }
+
+	// Voice render oversampling, set by the oversampling parameter. Offline renders always use the highest factor
+	enum class Oversampling
+	{
+		none = 0,
+		x2,
+		x4
+	};
+
+	Oversampling getOversampling() const { return static_cast<Oversampling>(oversampling.load()); }
+
+	// Timestamped change for the next processBlock, by ParameterSnapshot index. For wrappers and hosts
+	// that deliver sample-accurate automation, audio thread only. Editor changes are stamped by the
+	// processor itself, and parameters without changes still follow their atomics once per block.
+	void addParameterEvent(int parameterIndex, float value, int samplePosition);
+
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PocketsynthAudioProcessor)
@@ -94,13 +119,54 @@ private:
     juce::AudioProcessorValueTreeState treeState;
     juce::UndoManager undoManager;
 	juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-	void parameterChanged(const juce::String& parameterID, float newValue) override;
+	void parameterValueChanged(int parameterIndex, float newValue) override;
+	void parameterGestureChanged(int, bool) override {}
 
     // Midi management
     juce::MidiKeyboardState midiKeyboardState;
 
 	// Synthesiser components
 	void setupSynth();
-    juce::Synthesiser synth;
+	juce::SharedResourcePointer<WavetableBank> wavetableBank;
+	ParameterSnapshot parameters; // Read once at the top of each block, only touched on the audio thread after construction
+	ParameterSnapshot::Reader parameterReader;
+	ParameterEventBuffer parameterEvents;
+	ParameterChangeQueue editorChanges; // Message thread changes, stamped for the next block's parameterEvents
+	void parameterEventReached(int parameterIndex, float value) override;
+    PocketSynthesiser synth;
+
+	// Engine parameters that start or stop threads or re-prepare the processor are applied on the message thread
+	std::atomic<int> requestedRenderThreads{ 1 };
+	std::atomic<int> requestedOversampling{ static_cast<int>(Oversampling::none) };
+	void setOversampling(Oversampling newOversampling);
+	void handleAsyncUpdate() override;
+
+	// The snapshot the envelope coefficients were last calculated from. Only its envelope values are
+	// compared, so coefficients are recalculated on blocks where one of those differs. Audio thread only.
+	std::array<float, ParameterRegistry::numParameters> appliedEnvelopeParameters{};
+	bool haveEnvelopeParametersChanged() const;
+	void updateEnvelopeCoefficients();
+
+	// Master output gain, ramped between blocks so changes don't zipper
+	static constexpr double masterGainSmoothingSeconds = 0.02;
+	static constexpr int masterGainChunkSize = 256;
+	juce::SmoothedValue<float> masterGain;
+	alignas(32) std::array<float, masterGainChunkSize> masterGainRamp{};
+	void applyMasterGain(juce::AudioBuffer<float>& buffer, int numChannels);
+
+	// Post-synth effects, run on the whole block before the master gain
+	EffectsChain effects;
+
+	// Voices render at oversamplingFactor times the host rate into the oversampler's last stage buffer,
+	// which is then decimated through polyphase half-band IIR stages. Rebuilt in prepareToPlay, null at 1x
+	std::atomic<int> oversampling{ static_cast<int>(Oversampling::none) };
+	std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+	juce::dsp::AudioBlock<float> oversampledStorage;
+	int oversamplingFactor = 1;
+	juce::MidiBuffer oversampledMidi;
+	std::array<float*, 2> oversampledChannels{};
+	void renderVoices(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages);
+	void renderOversampled(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midiMessages);
+	static double getDecimationLatency(int factorLog2);
 
 };
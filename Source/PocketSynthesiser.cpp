@@ -0,0 +1,458 @@
+/*
+  ==============================================================================
+
+    PocketSynthesiser.cpp
+    Created: 17 Oct 2026 8:40:12pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#include "PocketSynthesiser.h"
+
+void PocketSynthesiser::prepare(int samplesPerBlock, int numOutputChannels)
+{
+	const juce::ScopedLock sl(lock);
+
+	voiceBufferSize = juce::jmax(1, samplesPerBlock);
+	voiceBuffers.resize(static_cast<size_t>(maxVoices));
+
+	for (auto& buffer : voiceBuffers)
+		buffer.setSize(juce::jmax(1, numOutputChannels), voiceBufferSize);
+
+	int numVoices = juce::jmin(voices.size(), maxVoices);
+	allocator.reset(numVoices);
+	noteVoices.fill(-1);
+
+	for (int i = 0; i < numVoices; ++i)
+	{
+		oscillatorVoices[static_cast<size_t>(i)] = dynamic_cast<OscillatorVoice*>(voices.getUnchecked(i));
+		voiceAges[static_cast<size_t>(i)] = static_cast<juce::uint32>(i);
+
+		// Every voice is expected to be an OscillatorVoice
+		jassert(oscillatorVoices[static_cast<size_t>(i)] != nullptr);
+	}
+
+	noteCounter = static_cast<juce::uint32>(numVoices);
+	updateVoicePriorities();
+
+	filterBank.prepare(getSampleRate());
+	filterVoicesActive.fill(false);
+
+	channelVoices.fill(-1);
+	channelPressures.fill(0.0f);
+	channelSlides.fill(0.5f);
+
+	for (auto* voice : voices)
+		if (auto* oscillatorVoice = dynamic_cast<OscillatorVoice*>(voice))
+			oscillatorVoice->setMpeMode(mpeEnabled);
+}
+
+void PocketSynthesiser::setMpeEnabled(bool shouldBeEnabled)
+{
+	const juce::ScopedLock sl(lock);
+	mpeEnabled = shouldBeEnabled;
+	channelVoices.fill(-1);
+
+	for (auto* voice : voices)
+	{
+		if (auto* oscillatorVoice = dynamic_cast<OscillatorVoice*>(voice))
+		{
+			oscillatorVoice->setMpeMode(mpeEnabled);
+			oscillatorVoice->setMasterPitchBend(0.0f);
+		}
+	}
+}
+
+void PocketSynthesiser::setEnvelopeParameters(int oscillator, const Envelope::Parameters& parameters)
+{
+	envelopeCoefficients[static_cast<size_t>(oscillator)].calculate(parameters, getSampleRate());
+}
+
+void PocketSynthesiser::updateModulation(const ParameterSnapshot& parameters)
+{
+	modulationRouting.update(parameters, getSampleRate(), modulationControlInterval.load());
+}
+
+void PocketSynthesiser::setFilterEnvelopeParameters(const Envelope::Parameters& parameters)
+{
+	filterEnvelopeCoefficients.calculate(parameters, getSampleRate());
+}
+
+void PocketSynthesiser::updateFilter(const ParameterSnapshot& parameters)
+{
+	// Filter type choices are the filter bank's types in order, starting with "Off"
+	static_assert(ParameterRegistry::globalSpecs[ParameterRegistry::filterType].maximum == VoiceFilterBank<maxVoices>::highPass,
+		"Filter type choices must match VoiceFilterBank::Type");
+
+	VoiceFilterBank<maxVoices>::Parameters filter;
+	filter.type = static_cast<int>(parameters.get(ParameterRegistry::filterType));
+	filter.cutoff = parameters.get(ParameterRegistry::filterCutoff);
+	filter.resonance = parameters.get(ParameterRegistry::filterResonance);
+	filter.envelopeAmount = parameters.get(ParameterRegistry::filterEnvelopeAmount);
+	filterBank.setParameters(filter);
+}
+
+void PocketSynthesiser::setNumRenderThreads(int numThreads)
+{
+	// The pool only holds the synth lock to swap its workers, so a render never waits on threads starting
+	pool.setNumWorkers(juce::jlimit(0, juce::SystemStats::getNumCpus() - 1, numThreads - 1), lock);
+}
+
+void PocketSynthesiser::renderNextBlockScheduled(juce::AudioBuffer<float>& outputBuffer, const juce::MidiBuffer& midiMessages,
+	const ParameterEventBuffer& parameterEvents, int startSample, int numSamples)
+{
+	const juce::ScopedLock sl(lock);
+
+	scheduler.process(midiMessages, parameterEvents, startSample, numSamples,
+		[this, &outputBuffer](int subBlockStart, int subBlockSize) { renderVoices(outputBuffer, subBlockStart, subBlockSize); },
+		[this](const juce::MidiMessage& message) { handleMidiEvent(message); });
+}
+
+void PocketSynthesiser::setMinimumSubBlockSize(int numSamples)
+{
+	const juce::ScopedLock sl(lock);
+	scheduler.setMinimumSubBlockSize(numSamples);
+}
+
+void PocketSynthesiser::renderVoices(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+	// Before prepare, or with voices the buffers were not made for, fall back on juce::Synthesiser
+	if (voices.size() > static_cast<int>(voiceBuffers.size())
+		|| voiceBuffers.front().getNumChannels() != outputBuffer.getNumChannels())
+	{
+		juce::Synthesiser::renderVoices(outputBuffer, startSample, numSamples);
+		modulationRouting.advanceGlobalLfo(numSamples);
+		updateVoicePriorities();
+		return;
+	}
+
+	while (numSamples > 0)
+	{
+		int numThisTime = juce::jmin(numSamples, voiceBufferSize);
+		int numActiveVoices = 0;
+
+		for (int i = 0; i < voices.size(); ++i)
+			if (voices.getUnchecked(i)->isVoiceActive())
+				activeVoiceIndices[static_cast<size_t>(numActiveVoices++)] = i;
+
+		if (pool.getNumWorkers() > 0)
+		{
+			jobNumSamples = numThisTime;
+			pool.run(*this, numActiveVoices);
+		}
+		else
+		{
+			renderBank(numActiveVoices, numThisTime);
+		}
+
+		// Filter memory from before the filter was last turned off is stale, so every voice starts clear
+		if (filterBank.isEnabled())
+			filterVoices(numActiveVoices, numThisTime);
+		else
+			filterVoicesActive.fill(false);
+
+		// Fixed summation order, independent of which thread rendered which voice
+		for (int i = 0; i < numActiveVoices; ++i)
+		{
+			auto& voiceBuffer = voiceBuffers[static_cast<size_t>(activeVoiceIndices[static_cast<size_t>(i)])];
+
+			for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+				outputBuffer.addFrom(channel, startSample, voiceBuffer, channel, 0, numThisTime);
+		}
+
+		modulationRouting.advanceGlobalLfo(numThisTime);
+
+		startSample += numThisTime;
+		numSamples -= numThisTime;
+	}
+
+	updateVoicePriorities();
+}
+
+// Serial render of the active voices into their buffers, a chunk of the voices' grid at a time.
+// Each voice prepares its chunk, the bank renders every prepared row in one pass, then each voice
+// mixes its rows through its envelopes. Voices that render a chunk themselves do it in the first pass.
+void PocketSynthesiser::renderBank(int numActiveVoices, int numSamples)
+{
+	for (int i = 0; i < numActiveVoices; ++i)
+	{
+		auto voiceIndex = static_cast<size_t>(activeVoiceIndices[static_cast<size_t>(i)]);
+		voiceBuffers[voiceIndex].clear(0, numSamples);
+		oscillatorVoices[voiceIndex]->beginRender(numSamples);
+	}
+
+	for (int start = 0; start < numSamples; start += OscillatorVoice::renderChunkSize)
+	{
+		int numThisTime = juce::jmin(OscillatorVoice::renderChunkSize, numSamples - start);
+		int numBankVoices = 0;
+		int numRows = 0;
+
+		for (int i = 0; i < numActiveVoices; ++i)
+		{
+			auto voiceIndex = static_cast<size_t>(activeVoiceIndices[static_cast<size_t>(i)]);
+			auto* voice = oscillatorVoices[voiceIndex];
+
+			if (voice->isVoiceActive() && voice->prepareBankChunk(voiceBuffers[voiceIndex], start, numThisTime))
+			{
+				bankVoiceIndices[static_cast<size_t>(numBankVoices++)] = static_cast<int>(voiceIndex);
+				numRows += voice->getBankRows(bankRows.data() + numRows, bankLefts.data() + numRows, bankRights.data() + numRows);
+			}
+		}
+
+		voiceBank.render(bankRows.data(), bankLefts.data(), bankRights.data(), numRows, numThisTime);
+
+		for (int i = 0; i < numBankVoices; ++i)
+		{
+			auto voiceIndex = static_cast<size_t>(bankVoiceIndices[static_cast<size_t>(i)]);
+			oscillatorVoices[voiceIndex]->finishBankChunk(voiceBuffers[voiceIndex], start, numThisTime);
+		}
+	}
+}
+
+void PocketSynthesiser::filterVoices(int numActiveVoices, int numSamples)
+{
+	for (int i = 0; i < numActiveVoices; ++i)
+	{
+		auto voiceIndex = static_cast<size_t>(activeVoiceIndices[static_cast<size_t>(i)]);
+
+		if (!filterVoicesActive[voiceIndex])
+			filterBank.resetVoice(static_cast<int>(voiceIndex));
+
+		activeVoiceBuffers[static_cast<size_t>(i)] = &voiceBuffers[voiceIndex];
+		activeFilterEnvelopes[static_cast<size_t>(i)] = oscillatorVoices[voiceIndex]->getFilterEnvelope();
+	}
+
+	filterBank.process(activeVoiceBuffers.data(), activeVoiceIndices.data(), activeFilterEnvelopes.data(), numActiveVoices, numSamples);
+
+	// A voice that finished during this render starts from a clear filter when it next plays
+	for (int i = 0; i < voices.size(); ++i)
+		filterVoicesActive[static_cast<size_t>(i)] = voices.getUnchecked(i)->isVoiceActive();
+}
+
+void PocketSynthesiser::runJob(int index)
+{
+	int voiceIndex = activeVoiceIndices[static_cast<size_t>(index)];
+	auto& voiceBuffer = voiceBuffers[static_cast<size_t>(voiceIndex)];
+
+	voiceBuffer.clear(0, jobNumSamples);
+	voices.getUnchecked(voiceIndex)->renderNextBlock(voiceBuffer, 0, jobNumSamples);
+}
+
+void PocketSynthesiser::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+	const juce::ScopedLock sl(lock);
+
+	if (!isAllocatorReady())
+	{
+		juce::Synthesiser::noteOn(midiChannel, midiNoteNumber, velocity);
+		return;
+	}
+
+	for (auto* sound : sounds)
+	{
+		if (!sound->appliesToNote(midiNoteNumber) || !sound->appliesToChannel(midiChannel))
+			continue;
+
+		// A voice still ringing on this key, held by the sustain pedal, is released first
+		int& noteVoice = noteVoices[static_cast<size_t>(((midiChannel - 1) & 15) * 128 + (midiNoteNumber & 127))];
+
+		if (noteVoice >= 0)
+		{
+			auto* ringingVoice = voices.getUnchecked(noteVoice);
+
+			if (ringingVoice->getCurrentlyPlayingNote() == midiNoteNumber && ringingVoice->isPlayingChannel(midiChannel))
+			{
+				stopVoice(ringingVoice, 1.0f, true);
+				updateVoicePriority(noteVoice);
+			}
+		}
+
+		// The top of the heap is a free voice if there is one, otherwise the best voice to steal
+		int index = allocator.getBestVoice();
+		auto* voice = oscillatorVoices[static_cast<size_t>(index)];
+
+		if (voice->isVoiceActive())
+		{
+			if (!isNoteStealingEnabled())
+				continue;
+
+			voice->steal();
+		}
+
+		startVoice(voice, sound, midiChannel, midiNoteNumber, velocity);
+		voiceAges[static_cast<size_t>(index)] = ++noteCounter;
+		noteVoice = index;
+		updateVoicePriority(index);
+
+		auto channelIndex = static_cast<size_t>((midiChannel - 1) & 15);
+		channelVoices[channelIndex] = index;
+		voice->resetExpression(channelPressures[channelIndex], channelSlides[channelIndex]);
+	}
+}
+
+void PocketSynthesiser::noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff)
+{
+	const juce::ScopedLock sl(lock);
+	juce::Synthesiser::noteOff(midiChannel, midiNoteNumber, velocity, allowTailOff);
+
+	if (!isAllocatorReady())
+		return;
+
+	int noteVoice = noteVoices[static_cast<size_t>(((midiChannel - 1) & 15) * 128 + (midiNoteNumber & 127))];
+
+	if (noteVoice >= 0)
+		updateVoicePriority(noteVoice);
+}
+
+bool PocketSynthesiser::isAllocatorReady() const
+{
+	return allocator.getNumVoices() > 0 && allocator.getNumVoices() == voices.size();
+}
+
+// Free voices first, then released, then held, each oldest first. Voices above the limit are never
+// picked while a voice under it exists.
+int PocketSynthesiser::getVoiceTier(int index) const
+{
+	using Allocator = VoiceAllocator<maxVoices>;
+	auto* voice = oscillatorVoices[static_cast<size_t>(index)];
+
+	if (index >= getVoiceLimit())
+		return Allocator::unavailable;
+
+	if (!voice->isVoiceActive())
+		return Allocator::free;
+
+	return voice->isPlayingButReleased() ? Allocator::released : Allocator::held;
+}
+
+// Re-ranks one voice by its tier, envelope level and age, moving only that voice in the heap
+void PocketSynthesiser::updateVoicePriority(int index)
+{
+	VoiceAllocator<maxVoices>::Priority priority;
+	priority.tier = getVoiceTier(index);
+	priority.level = priority.tier == VoiceAllocator<maxVoices>::free ? 0.0f : oscillatorVoices[static_cast<size_t>(index)]->getEnvelopeLevel();
+	priority.age = voiceAges[static_cast<size_t>(index)];
+	allocator.setPriority(index, priority);
+}
+
+// Picks up voices that finished, were released by the pedal, crossed the voice limit or changed
+// level while rendering. Only voices whose key changed move in the heap, so the top is always the
+// best voice to steal without re-ranking anything on a note-on.
+void PocketSynthesiser::updateVoicePriorities()
+{
+	if (!isAllocatorReady())
+		return;
+
+	for (int i = 0; i < allocator.getNumVoices(); ++i)
+	{
+		const auto& priority = allocator.getPriority(i);
+		int tier = getVoiceTier(i);
+		float level = tier == VoiceAllocator<maxVoices>::free ? 0.0f : oscillatorVoices[static_cast<size_t>(i)]->getEnvelopeLevel();
+
+		if (tier != priority.tier || level != priority.level)
+			updateVoicePriority(i);
+	}
+}
+
+void PocketSynthesiser::handlePitchWheel(int midiChannel, int wheelValue)
+{
+	const juce::ScopedLock sl(lock);
+
+	if (!mpeEnabled || !isAllocatorReady())
+	{
+		juce::Synthesiser::handlePitchWheel(midiChannel, wheelValue);
+		return;
+	}
+
+	// The master channel bends the whole zone
+	if (midiChannel == mpeMasterChannel)
+	{
+		float semitones = static_cast<float>(wheelValue - 8192) / 8192.0f * mpeMasterPitchBendRange;
+
+		for (int i = 0; i < allocator.getNumVoices(); ++i)
+			oscillatorVoices[static_cast<size_t>(i)]->setMasterPitchBend(semitones);
+
+		return;
+	}
+
+	if (auto* voice = getChannelVoice(midiChannel))
+		voice->pitchWheelMoved(wheelValue);
+}
+
+void PocketSynthesiser::handleController(int midiChannel, int controllerNumber, int controllerValue)
+{
+	const juce::ScopedLock sl(lock);
+
+	if (controllerNumber == mpeSlideController)
+		channelSlides[static_cast<size_t>((midiChannel - 1) & 15)] = static_cast<float>(controllerValue) / 127.0f;
+
+	if (controllerNumber == mpeSlideController && isMpeMemberChannel(midiChannel))
+	{
+		if (auto* voice = getChannelVoice(midiChannel))
+			voice->controllerMoved(controllerNumber, controllerValue);
+
+		return;
+	}
+
+	juce::Synthesiser::handleController(midiChannel, controllerNumber, controllerValue);
+}
+
+void PocketSynthesiser::handleChannelPressure(int midiChannel, int channelPressureValue)
+{
+	const juce::ScopedLock sl(lock);
+	channelPressures[static_cast<size_t>((midiChannel - 1) & 15)] = static_cast<float>(channelPressureValue) / 127.0f;
+
+	if (isMpeMemberChannel(midiChannel))
+	{
+		if (auto* voice = getChannelVoice(midiChannel))
+			voice->channelPressureChanged(channelPressureValue);
+
+		return;
+	}
+
+	juce::Synthesiser::handleChannelPressure(midiChannel, channelPressureValue);
+}
+
+void PocketSynthesiser::handleAftertouch(int midiChannel, int midiNoteNumber, int aftertouchValue)
+{
+	const juce::ScopedLock sl(lock);
+
+	if (!isAllocatorReady())
+	{
+		juce::Synthesiser::handleAftertouch(midiChannel, midiNoteNumber, aftertouchValue);
+		return;
+	}
+
+	if (auto* voice = getNoteVoice(midiChannel, midiNoteNumber))
+		voice->aftertouchChanged(aftertouchValue);
+}
+
+bool PocketSynthesiser::isMpeMemberChannel(int midiChannel) const
+{
+	return mpeEnabled && isAllocatorReady() && midiChannel != mpeMasterChannel;
+}
+
+// The voice still playing this note on this channel, if any
+OscillatorVoice* PocketSynthesiser::getNoteVoice(int midiChannel, int midiNoteNumber) const
+{
+	int index = noteVoices[static_cast<size_t>(((midiChannel - 1) & 15) * 128 + (midiNoteNumber & 127))];
+
+	if (index < 0)
+		return nullptr;
+
+	auto* voice = oscillatorVoices[static_cast<size_t>(index)];
+	return voice->getCurrentlyPlayingNote() == midiNoteNumber && voice->isPlayingChannel(midiChannel) ? voice : nullptr;
+}
+
+// The voice still playing on this channel, if any. In MPE mode a member channel has one note at a time
+OscillatorVoice* PocketSynthesiser::getChannelVoice(int midiChannel) const
+{
+	int index = channelVoices[static_cast<size_t>((midiChannel - 1) & 15)];
+
+	if (index < 0)
+		return nullptr;
+
+	auto* voice = oscillatorVoices[static_cast<size_t>(index)];
+	return voice->isPlayingChannel(midiChannel) ? voice : nullptr;
+}
\ No newline at end of file
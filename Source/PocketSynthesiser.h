@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    PocketSynthesiser.h
+    Created: 17 Oct 2026 8:40:12pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "RenderThreadPool.h"
+#include "OscillatorVoice.h"
+#include "VoiceAllocator.h"
+#include "MidiScheduler.h"
+#include "VoiceFilterBank.h"
+#include "VoiceBank.h"
+
+// juce::Synthesiser with a structure-of-arrays voice render and an optional multi-core one.
+// Every active voice renders into its own preallocated buffer, then the buffers are summed in voice
+// order. With no worker threads the voices render through the VoiceBank: each chunk runs every
+// voice's control work, then renders the oscillator rows of all of them in one sweep of the bank,
+// then mixes each voice through its envelopes. In parallel mode each voice renders its own rows on
+// the worker pool. Both do the same arithmetic, so the result is bit-identical whatever the thread count.
+//
+// Note-ons pick their OscillatorVoice from a VoiceAllocator heap instead of scanning every voice,
+// and a stolen voice fades its old note out before the new one starts.
+//
+// With MPE enabled the synth works as an MPE lower zone: channel 1 is the master channel and every
+// other channel carries one note's own pitch bend, pressure and slide. Per-note messages find their
+// voice through channel and note tables instead of scanning the voices.
+//
+// While the filter is on, the filter bank runs over the voices' buffers before they are summed.
+class PocketSynthesiser : public juce::Synthesiser,
+	                      private RenderThreadPool::Job
+{
+public:
+	static constexpr int maxVoices = ParameterRegistry::maxVoices;
+
+	// Oscillator lanes for every voice, each voice is given its rows when it is created
+	VoiceBank& getVoiceBank() { return voiceBank; }
+
+	// Allocates the per-voice buffers and resets the allocator, call from prepareToPlay once the voices are added
+	void prepare(int samplesPerBlock, int numOutputChannels);
+
+	// Voices are all created up front, the limit only caps how many of them take new notes.
+	// Real-time safe, so it can follow automation on any thread
+	void setVoiceLimit(int newLimit) { voiceLimit.store(juce::jlimit(1, maxVoices, newLimit)); }
+	int getVoiceLimit() const { return voiceLimit.load(); }
+
+	// Recalculates one oscillator's envelope coefficients, shared by every voice. Call on the audio
+	// thread when the envelope parameters have changed, after the sample rate is set
+	void setEnvelopeParameters(int oscillator, const Envelope::Parameters& parameters);
+	const OscillatorVoice::EnvelopeCoefficients& getEnvelopeCoefficients() const { return envelopeCoefficients; }
+
+	// Rebuilds the modulation routes shared by every voice. Call on the audio thread between renders,
+	// after the sample rate is set
+	void updateModulation(const ParameterSnapshot& parameters);
+	const ModulationMatrix::Routing& getModulationRouting() const { return modulationRouting; }
+
+	// Recalculates the filter envelope coefficients shared by every voice. Same rules as setEnvelopeParameters
+	void setFilterEnvelopeParameters(const Envelope::Parameters& parameters);
+	const Envelope::Coefficients& getFilterEnvelopeCoefficients() const { return filterEnvelopeCoefficients; }
+
+	// Picks up the filter type, cutoff, resonance and envelope amount. Call on the audio thread between renders
+	void updateFilter(const ParameterSnapshot& parameters);
+
+	// Samples between modulation source evaluations, applied from the next updateModulation
+	void setModulationControlInterval(int numSamples) { modulationControlInterval.store(numSamples); }
+	int getModulationControlInterval() const { return modulationControlInterval.load(); }
+
+	// Total threads rendering voices, including the audio thread. 1 renders serially.
+	// Starts and stops threads, so call on the message thread
+	void setNumRenderThreads(int numThreads);
+	int getNumRenderThreads() const { return pool.getNumWorkers() + 1; }
+
+	// Use instead of renderNextBlock. Notes start and stop on their exact sample, while controller and
+	// parameter streams are coalesced so they never split the block into sub-blocks shorter than the minimum size
+	void renderNextBlockScheduled(juce::AudioBuffer<float>& outputBuffer, const juce::MidiBuffer& midiMessages,
+		const ParameterEventBuffer& parameterEvents, int startSample, int numSamples);
+	void setMinimumSubBlockSize(int numSamples);
+
+	// Takes the synth lock, so call between renders rather than from inside one
+	void setMpeEnabled(bool shouldBeEnabled);
+	bool isMpeEnabled() const { return mpeEnabled; }
+
+	void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+	void noteOff(int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff) override;
+	void handlePitchWheel(int midiChannel, int wheelValue) override;
+	void handleController(int midiChannel, int controllerNumber, int controllerValue) override;
+	void handleChannelPressure(int midiChannel, int channelPressureValue) override;
+	void handleAftertouch(int midiChannel, int midiNoteNumber, int aftertouchValue) override;
+
+protected:
+	void renderVoices(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
+
+private:
+	std::atomic<int> voiceLimit{ maxVoices };
+	OscillatorVoice::EnvelopeCoefficients envelopeCoefficients{};
+	ModulationMatrix::Routing modulationRouting;
+	std::atomic<int> modulationControlInterval{ 16 };
+	Envelope::Coefficients filterEnvelopeCoefficients{};
+	VoiceFilterBank<maxVoices> filterBank;
+	std::array<bool, maxVoices> filterVoicesActive{}; // Voices still sounding after the last render, the rest start with clear filters
+
+	// Allocation, only touched under the synth lock
+	VoiceAllocator<maxVoices> allocator;
+	std::array<OscillatorVoice*, maxVoices> oscillatorVoices{};
+	std::array<juce::uint32, maxVoices> voiceAges{};
+	juce::uint32 noteCounter = 0;
+	std::array<int, 16 * 128> noteVoices{}; // Last voice started for each channel and note
+
+	// MPE routing and the last expression sent on each channel, picked up by the next note started on it
+	static constexpr int mpeMasterChannel = 1;
+	static constexpr float mpeMasterPitchBendRange = 2.0f;
+	static constexpr int mpeSlideController = 74;
+	bool mpeEnabled = false;
+	std::array<int, 16> channelVoices{}; // Last voice started on each channel
+	std::array<float, 16> channelPressures{};
+	std::array<float, 16> channelSlides{};
+
+	MidiScheduler scheduler;
+	RenderThreadPool pool;
+	std::vector<juce::AudioBuffer<float>> voiceBuffers;
+	int voiceBufferSize = 0;
+
+	// The bank, and the rows of one chunk of the serial render with the voices that left them there
+	VoiceBank voiceBank;
+	static constexpr int maxBankRows = maxVoices * OscillatorVoice::numOscillators;
+	std::array<int, maxBankRows> bankRows{};
+	std::array<float*, maxBankRows> bankLefts{};
+	std::array<float*, maxBankRows> bankRights{};
+	std::array<int, maxVoices> bankVoiceIndices{};
+
+	// State of the batch being rendered by the pool
+	std::array<int, maxVoices> activeVoiceIndices{};
+	int jobNumSamples = 0;
+
+	// The same batch, as the filter bank takes it
+	std::array<juce::AudioBuffer<float>*, maxVoices> activeVoiceBuffers{};
+	std::array<const float*, maxVoices> activeFilterEnvelopes{};
+
+	bool isAllocatorReady() const;
+	bool isMpeMemberChannel(int midiChannel) const;
+	OscillatorVoice* getNoteVoice(int midiChannel, int midiNoteNumber) const;
+	OscillatorVoice* getChannelVoice(int midiChannel) const;
+	int getVoiceTier(int index) const;
+	void updateVoicePriority(int index);
+	void updateVoicePriorities();
+	void renderBank(int numActiveVoices, int numSamples);
+	void filterVoices(int numActiveVoices, int numSamples);
+
+	void runJob(int index) override;
+};
\ No newline at end of file
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    RenderThreadPool.h
+    Created: 17 Oct 2026 8:15:37pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Small fork-join pool of real-time worker threads for splitting a block's rendering across cores.
+// The audio thread hands over a batch of jobs, works on the batch itself as well, and waits for
+// every worker to finish before returning, so no worker can still be touching a batch once run() has returned.
+class RenderThreadPool
+{
+public:
+	struct Job
+	{
+		virtual ~Job() = default;
+		virtual void runJob(int index) = 0;
+	};
+
+	~RenderThreadPool()
+	{
+		workers.clear();
+	}
+
+	// Starts or stops worker threads. Not real-time safe. Calls to run() must hold renderLock, which is
+	// only taken to swap in the new workers, so a render never waits on threads starting or stopping.
+	void setNumWorkers(int numWorkers, const juce::CriticalSection& renderLock)
+	{
+		juce::OwnedArray<Worker> newWorkers;
+		int numCpus = juce::SystemStats::getNumCpus();
+
+		for (int i = 0; i < numWorkers; ++i)
+		{
+			auto* worker = newWorkers.add(new Worker(*this));
+
+			// Keep each worker on its own core, leaving the first one for the host's audio thread
+			if (numCpus > 1)
+				worker->setAffinityMask(1u << static_cast<juce::uint32>((i + 1) % juce::jmin(numCpus, 32)));
+
+			worker->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10));
+		}
+
+		{
+			const juce::ScopedLock sl(renderLock);
+			workers.swapWith(newWorkers);
+		}
+
+		// The old workers are idle, and stop as newWorkers goes out of scope
+	}
+
+	int getNumWorkers() const
+	{
+		return workers.size();
+	}
+
+	// Runs job.runJob(i) for every i in [0, numJobs) and returns once all of them have finished
+	void run(Job& job, int numJobs)
+	{
+		if (workers.isEmpty() || numJobs < 2)
+		{
+			for (int i = 0; i < numJobs; ++i)
+				job.runJob(i);
+			return;
+		}
+
+		currentJob = &job;
+		totalJobs = numJobs;
+		nextJob.store(0);
+
+		// The audio thread takes one job itself, so only wake as many workers as there are jobs left over
+		int numToWake = juce::jmin(numJobs - 1, workers.size());
+		busyWorkers.store(numToWake, std::memory_order_release);
+
+		for (int i = 0; i < numToWake; ++i)
+			workers.getUnchecked(i)->wake.signal();
+
+		runAvailableJobs();
+
+		while (busyWorkers.load(std::memory_order_acquire) > 0)
+			juce::Thread::yield();
+
+		currentJob = nullptr;
+	}
+
+private:
+	struct Worker : public juce::Thread
+	{
+		Worker(RenderThreadPool& owner) : juce::Thread("Voice render worker"), pool(owner) {}
+
+		~Worker() override
+		{
+			signalThreadShouldExit();
+			wake.signal();
+			stopThread(1000);
+		}
+
+		void run() override
+		{
+			juce::ScopedNoDenormals noDenormals;
+
+			while (!threadShouldExit())
+			{
+				if (!wake.wait(100.0))
+					continue;
+
+				if (threadShouldExit())
+					break;
+
+				pool.runAvailableJobs();
+				pool.busyWorkers.fetch_sub(1, std::memory_order_acq_rel);
+			}
+		}
+
+		RenderThreadPool& pool;
+		juce::WaitableEvent wake;
+	};
+
+	juce::OwnedArray<Worker> workers;
+	Job* currentJob = nullptr;
+	int totalJobs = 0;
+	std::atomic<int> nextJob{ 0 };
+	std::atomic<int> busyWorkers{ 0 };
+
+	void runAvailableJobs()
+	{
+		for (int index = nextJob.fetch_add(1); index < totalJobs; index = nextJob.fetch_add(1))
+			currentJob->runJob(index);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    SmoothedParameter.h
+    Created: 18 Oct 2026 12:24:51am
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Linear smoothing for a continuous parameter, consumed a chunk at a time.
+// While the value is moving, getNextRamp writes one value per sample for the caller to multiply or
+// look up with. Once it settles, getNextRamp returns false and the caller uses getCurrentValue as a
+// scalar, so a parameter nobody is touching costs no more than an unsmoothed one.
+class SmoothedParameter
+{
+public:
+	void reset(double sampleRate, double rampSeconds)
+	{
+		value.reset(sampleRate, rampSeconds);
+	}
+
+	void setTargetValue(float newValue)
+	{
+		value.setTargetValue(newValue);
+	}
+
+	// Jumps straight to a value, as at the start of a note
+	void setCurrentAndTargetValue(float newValue)
+	{
+		value.setCurrentAndTargetValue(newValue);
+	}
+
+	bool isSmoothing() const
+	{
+		return value.isSmoothing();
+	}
+
+	float getCurrentValue() const
+	{
+		return value.getCurrentValue();
+	}
+
+	float getTargetValue() const
+	{
+		return value.getTargetValue();
+	}
+
+	// Writes the next numSamples values into ramp and returns true, or returns false without writing
+	// anything when the value is steady
+	bool getNextRamp(float* ramp, int numSamples)
+	{
+		if (!value.isSmoothing())
+			return false;
+
+		for (int i = 0; i < numSamples; ++i)
+			ramp[i] = value.getNextValue();
+
+		return true;
+	}
+
+	// Advances numSamples without rendering a ramp, for values only applied once per chunk
+	float skip(int numSamples)
+	{
+		return value.skip(numSamples);
+	}
+
+private:
+	juce::SmoothedValue<float> value;
+};
\ No newline at end of file
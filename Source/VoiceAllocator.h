@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    VoiceAllocator.h
+    Created: 17 Oct 2026 9:22:48pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Indexed binary heap of voices ordered by how good a choice each one is for the next note.
+// Free voices come first, then released ones, then held ones, each ordered by envelope level and
+// then age, so the top of the heap is either a free voice or the best one to steal. Changing one
+// voice's priority is O(log n), and looking up the best voice is O(1).
+template <int maxVoices>
+class VoiceAllocator
+{
+public:
+	enum Tier : int
+	{
+		free = 0,
+		released,
+		held,
+		unavailable // Above the voice limit, never picked while any other voice exists
+	};
+
+	struct Priority
+	{
+		int tier = free;
+		float level = 0.0f;
+		juce::uint32 age = 0;
+
+		bool isBefore(const Priority& other) const
+		{
+			if (tier != other.tier)
+				return tier < other.tier;
+
+			if (level != other.level)
+				return level < other.level;
+
+			// Smaller ages started earlier, wrapping around safely
+			return static_cast<juce::int32>(age - other.age) < 0;
+		}
+	};
+
+	// Puts every voice back in the heap as free, in index order
+	void reset(int newNumVoices)
+	{
+		numVoices = juce::jlimit(0, maxVoices, newNumVoices);
+
+		for (int i = 0; i < numVoices; ++i)
+		{
+			priorities[static_cast<size_t>(i)] = Priority{ free, 0.0f, static_cast<juce::uint32>(i) };
+			heap[static_cast<size_t>(i)] = i;
+			heapPositions[static_cast<size_t>(i)] = i;
+		}
+	}
+
+	int getNumVoices() const
+	{
+		return numVoices;
+	}
+
+	// Index of the best voice for a new note, or -1 when there are no voices
+	int getBestVoice() const
+	{
+		return numVoices > 0 ? heap[0] : -1;
+	}
+
+	const Priority& getPriority(int voice) const
+	{
+		return priorities[static_cast<size_t>(voice)];
+	}
+
+	void setPriority(int voice, const Priority& newPriority)
+	{
+		jassert(juce::isPositiveAndBelow(voice, numVoices));
+
+		bool moveUp = newPriority.isBefore(priorities[static_cast<size_t>(voice)]);
+		priorities[static_cast<size_t>(voice)] = newPriority;
+
+		if (moveUp)
+			siftUp(heapPositions[static_cast<size_t>(voice)]);
+		else
+			siftDown(heapPositions[static_cast<size_t>(voice)]);
+	}
+
+private:
+	std::array<Priority, maxVoices> priorities{};
+	std::array<int, maxVoices> heap{};
+	std::array<int, maxVoices> heapPositions{};
+	int numVoices = 0;
+
+	bool isBefore(int a, int b) const
+	{
+		return priorities[static_cast<size_t>(heap[static_cast<size_t>(a)])].isBefore(priorities[static_cast<size_t>(heap[static_cast<size_t>(b)])]);
+	}
+
+	void swap(int a, int b)
+	{
+		std::swap(heap[static_cast<size_t>(a)], heap[static_cast<size_t>(b)]);
+		heapPositions[static_cast<size_t>(heap[static_cast<size_t>(a)])] = a;
+		heapPositions[static_cast<size_t>(heap[static_cast<size_t>(b)])] = b;
+	}
+
+	void siftUp(int position)
+	{
+		while (position > 0)
+		{
+			int parent = (position - 1) / 2;
+
+			if (!isBefore(position, parent))
+				break;
+
+			swap(position, parent);
+			position = parent;
+		}
+	}
+
+	void siftDown(int position)
+	{
+		for (;;)
+		{
+			int best = position;
+			int left = 2 * position + 1;
+			int right = left + 1;
+
+			if (left < numVoices && isBefore(left, best))
+				best = left;
+
+			if (right < numVoices && isBefore(right, best))
+				best = right;
+
+			if (best == position)
+				break;
+
+			swap(position, best);
+			position = best;
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    VoiceBank.h
+    Created: 18 Oct 2026 4:12:36am
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WavetableBank.h"
+#include "ParameterRegistry.h"
+
+// Audio-rate oscillator state for every voice, in structure-of-arrays form.
+// Each oscillator of each voice owns one row of up to maxLanes unison lanes. The phases, increments
+// and stereo gains of every row sit in contiguous arrays, one cache line per row, next to each row's
+// lane count and band-limited tables. Oscillators write their lanes here when their control values
+// change, and the synth's serial render sweeps every sounding row of every voice in one pass.
+class VoiceBank
+{
+public:
+	static constexpr int maxLanes = 16;
+	static constexpr int numRows = ParameterRegistry::maxVoices * ParameterRegistry::numOscillators;
+	static constexpr int chunkSize = 64;
+
+	// Working space for one render, so renders of different rows on different threads never share it
+	struct Scratch
+	{
+		alignas(32) std::array<float, chunkSize> positions{};
+		alignas(32) std::array<float, chunkSize> laneBuffer{};
+	};
+
+	static constexpr int getRow(int voice, int oscillator)
+	{
+		return voice * ParameterRegistry::numOscillators + oscillator;
+	}
+
+	float* getPhases(int row) { return phases.data() + row * maxLanes; }
+	float* getIncrements(int row) { return increments.data() + row * maxLanes; }
+	float* getGainsLeft(int row) { return gainsLeft.data() + row * maxLanes; }
+	float* getGainsRight(int row) { return gainsRight.data() + row * maxLanes; }
+
+	void setNumLanes(int row, int newNumLanes)
+	{
+		numLanes[static_cast<size_t>(row)] = juce::jlimit(1, maxLanes, newNumLanes);
+	}
+
+	void setTables(int row, const WavetableBank::Table* lower, const WavetableBank::Table* upper, float crossfade)
+	{
+		lowerTables[static_cast<size_t>(row)] = lower;
+		upperTables[static_cast<size_t>(row)] = upper;
+		crossfades[static_cast<size_t>(row)] = crossfade;
+	}
+
+	// Renders a run of one row, overwriting left and right. Lanes are rendered a chunk at a time and
+	// mixed in with vector multiply-adds.
+	void renderRow(int row, float* left, float* right, int numSamples, Scratch& scratch)
+	{
+		juce::FloatVectorOperations::clear(left, numSamples);
+		juce::FloatVectorOperations::clear(right, numSamples);
+
+		auto r = static_cast<size_t>(row);
+
+		if (lowerTables[r] == nullptr)
+			return;
+
+		float* rowPhases = getPhases(row);
+		const float* rowIncrements = getIncrements(row);
+		const float* rowGainsLeft = getGainsLeft(row);
+		const float* rowGainsRight = getGainsRight(row);
+
+		while (numSamples > 0)
+		{
+			int numThisTime = juce::jmin(numSamples, chunkSize);
+
+			for (int lane = 0; lane < numLanes[r]; ++lane)
+			{
+				renderTableLane(*lowerTables[r], *upperTables[r], crossfades[r], rowPhases[lane], rowIncrements[lane],
+					scratch.positions.data(), scratch.laneBuffer.data(), numThisTime);
+				juce::FloatVectorOperations::addWithMultiply(left, scratch.laneBuffer.data(), rowGainsLeft[lane], numThisTime);
+				juce::FloatVectorOperations::addWithMultiply(right, scratch.laneBuffer.data(), rowGainsRight[lane], numThisTime);
+			}
+
+			left += numThisTime;
+			right += numThisTime;
+			numSamples -= numThisTime;
+		}
+	}
+
+	// Renders every listed row into its own left and right buffers, in one pass over the bank.
+	// Audio thread only, the bank's own scratch is shared by the whole pass.
+	void render(const int* rows, float* const* lefts, float* const* rights, int numRowsToRender, int numSamples)
+	{
+		for (int i = 0; i < numRowsToRender; ++i)
+			renderRow(rows[i], lefts[i], rights[i], numSamples, scratch);
+	}
+
+private:
+	alignas(64) std::array<float, numRows * maxLanes> phases{};
+	alignas(64) std::array<float, numRows * maxLanes> increments{};
+	alignas(64) std::array<float, numRows * maxLanes> gainsLeft{};
+	alignas(64) std::array<float, numRows * maxLanes> gainsRight{};
+	std::array<int, numRows> numLanes{};
+	std::array<const WavetableBank::Table*, numRows> lowerTables{};
+	std::array<const WavetableBank::Table*, numRows> upperTables{};
+	std::array<float, numRows> crossfades{};
+	Scratch scratch;
+
+	// Renders one lane from a pair of mipmap levels, advancing its phase. Both loops are branch-free so
+	// the compiler keeps them in SIMD lanes, only the table reads are scalar.
+	static void renderTableLane(const WavetableBank::Table& lowerTable, const WavetableBank::Table& upperTable, float crossfade,
+		float& phase, float increment, float* positions, float* destination, int numSamples)
+	{
+		const float* lower = lowerTable.data();
+		const float* upper = upperTable.data();
+		const float tableSize = static_cast<float>(WavetableBank::tableSize);
+
+		// Phase accumulation for the whole run
+		for (int i = 0; i < numSamples; ++i)
+		{
+			float p = phase + increment * static_cast<float>(i);
+			positions[i] = (p - std::floor(p)) * tableSize;
+		}
+
+		// Table reads, linear interpolation and the crossfade between mipmap levels
+		for (int i = 0; i < numSamples; ++i)
+		{
+			int index = static_cast<int>(positions[i]);
+			float fraction = positions[i] - static_cast<float>(index);
+			float lowerSample = lower[index] + fraction * (lower[index + 1] - lower[index]);
+			float upperSample = upper[index] + fraction * (upper[index + 1] - upper[index]);
+			destination[i] = lowerSample + crossfade * (upperSample - lowerSample);
+		}
+
+		float nextPhase = phase + increment * static_cast<float>(numSamples);
+		phase = nextPhase - std::floor(nextPhase);
+	}
+};
\ No newline at end of file
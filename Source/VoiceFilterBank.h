@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    VoiceFilterBank.h
+    Created: 18 Oct 2026 2:31:27am
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// One zero-delay-feedback state-variable filter per voice (the trapezoidal SVF from Andy Simper's
+// Cytomic notes), run on the voices' own render buffers before they are summed.
+// Voices are packed into the lanes of a SIMD register, so one pass of the filter equations runs as
+// many voices as the register has lanes, in lockstep. Samples are interleaved into a scratch buffer
+// once per control interval, so the filter loop itself only does aligned register loads and stores.
+// Each lane has its own coefficients, which follow that voice's filter envelope. They are only
+// recalculated every controlInterval samples, and only for lanes whose cutoff has moved by more
+// than cutoffThreshold.
+template <int maxVoices>
+class VoiceFilterBank
+{
+public:
+	using Register = juce::dsp::SIMDRegister<float>;
+	static constexpr int numLanes = static_cast<int>(Register::SIMDNumElements);
+	static constexpr int maxChannels = 2;
+	static constexpr int controlInterval = 32;
+	static constexpr float cutoffThreshold = 0.005f; // Relative change before tan() is recalculated
+	static constexpr float envelopeOctaves = 6.0f; // Cutoff shift at full envelope amount
+
+	enum Type : int
+	{
+		off = 0,
+		lowPass,
+		bandPass,
+		highPass
+	};
+
+	struct Parameters
+	{
+		int type = off;
+		float cutoff = 20000.0f;
+		float resonance = 0.0f;
+		float envelopeAmount = 0.0f;
+	};
+
+	void prepare(double newSampleRate)
+	{
+		sampleRate = static_cast<float>(newSampleRate);
+		maxCutoff = sampleRate * 0.49f;
+
+		for (int voice = 0; voice < maxVoices; ++voice)
+			resetVoice(voice);
+	}
+
+	void setParameters(const Parameters& newParameters)
+	{
+		// Damping only depends on resonance, so a change there means every voice's coefficients are stale
+		if (newParameters.resonance != parameters.resonance)
+			damping = 2.0f - 1.98f * juce::jlimit(0.0f, 1.0f, newParameters.resonance);
+
+		if (newParameters.resonance != parameters.resonance || newParameters.type != parameters.type)
+			cachedCutoffs.fill(0.0f);
+
+		parameters = newParameters;
+	}
+
+	bool isEnabled() const
+	{
+		return parameters.type != off;
+	}
+
+	// Clears a voice's filter memory, for when it starts from silence
+	void resetVoice(int voice)
+	{
+		auto v = static_cast<size_t>(voice);
+
+		for (auto& channel : states)
+		{
+			channel.ic1[v] = 0.0f;
+			channel.ic2[v] = 0.0f;
+		}
+
+		cachedCutoffs[v] = 0.0f;
+	}
+
+	// Filters numSamples of each listed voice's buffer in place. Envelopes holds one per-sample filter
+	// envelope per listed voice.
+	void process(juce::AudioBuffer<float>* const* buffers, const int* voiceIndices, const float* const* envelopes,
+		int numVoices, int numSamples)
+	{
+		if (!isEnabled())
+			return;
+
+		for (int first = 0; first < numVoices; first += numLanes)
+			processGroup(buffers + first, voiceIndices + first, envelopes + first, juce::jmin(numLanes, numVoices - first), numSamples);
+	}
+
+private:
+	// Filter memory per voice, gathered into registers for each group and written back afterwards
+	struct ChannelState
+	{
+		std::array<float, maxVoices> ic1{};
+		std::array<float, maxVoices> ic2{};
+	};
+
+	struct Coefficients
+	{
+		std::array<float, maxVoices> a1{};
+		std::array<float, maxVoices> a2{};
+		std::array<float, maxVoices> a3{};
+	};
+
+	Parameters parameters;
+	float sampleRate = 44100.0f;
+	float maxCutoff = 21609.0f;
+	float damping = 2.0f; // k, 2 is no resonance
+	std::array<ChannelState, maxChannels> states;
+	Coefficients coefficients;
+	std::array<float, maxVoices> cachedCutoffs{};
+
+	// One control interval of one channel, sample-major so each register loads one sample of every lane
+	alignas(Register::SIMDRegisterSize) std::array<float, controlInterval * numLanes> interleaved{};
+	alignas(Register::SIMDRegisterSize) std::array<float, numLanes> laneValues{};
+
+	void updateCoefficients(size_t voice, float envelope)
+	{
+		float cutoff = parameters.cutoff * std::exp2(parameters.envelopeAmount * envelopeOctaves * envelope);
+		cutoff = juce::jlimit(20.0f, maxCutoff, cutoff);
+
+		if (std::abs(cutoff - cachedCutoffs[voice]) <= cutoffThreshold * cachedCutoffs[voice])
+			return;
+
+		cachedCutoffs[voice] = cutoff;
+
+		float g = std::tan(juce::MathConstants<float>::pi * cutoff / sampleRate);
+		coefficients.a1[voice] = 1.0f / (1.0f + g * (g + damping));
+		coefficients.a2[voice] = g * coefficients.a1[voice];
+		coefficients.a3[voice] = g * coefficients.a2[voice];
+	}
+
+	// Loads one value per lane from a per-voice array, unused lanes read zero
+	Register gather(const std::array<float, maxVoices>& source, const std::array<size_t, numLanes>& voices, int numVoices)
+	{
+		laneValues.fill(0.0f);
+
+		for (int lane = 0; lane < numVoices; ++lane)
+			laneValues[static_cast<size_t>(lane)] = source[voices[static_cast<size_t>(lane)]];
+
+		return Register::fromRawArray(laneValues.data());
+	}
+
+	void scatter(Register value, std::array<float, maxVoices>& destination, const std::array<size_t, numLanes>& voices, int numVoices)
+	{
+		value.copyToRawArray(laneValues.data());
+
+		for (int lane = 0; lane < numVoices; ++lane)
+			destination[voices[static_cast<size_t>(lane)]] = laneValues[static_cast<size_t>(lane)];
+	}
+
+	void processGroup(juce::AudioBuffer<float>* const* buffers, const int* voiceIndices, const float* const* envelopes,
+		int numVoices, int numSamples)
+	{
+		int numChannels = juce::jmin(maxChannels, buffers[0]->getNumChannels());
+
+		std::array<size_t, numLanes> voices{};
+		std::array<float*, numLanes * maxChannels> channelData{};
+
+		for (int lane = 0; lane < numVoices; ++lane)
+		{
+			voices[static_cast<size_t>(lane)] = static_cast<size_t>(voiceIndices[lane]);
+
+			for (int channel = 0; channel < numChannels; ++channel)
+				channelData[static_cast<size_t>(channel * numLanes + lane)] = buffers[lane]->getWritePointer(channel);
+		}
+
+		std::array<Register, maxChannels> ic1{}, ic2{};
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			ic1[static_cast<size_t>(channel)] = gather(states[static_cast<size_t>(channel)].ic1, voices, numVoices);
+			ic2[static_cast<size_t>(channel)] = gather(states[static_cast<size_t>(channel)].ic2, voices, numVoices);
+		}
+
+		// Output is m0 * input + m1 * band + m2 * low
+		float m0 = parameters.type == highPass ? 1.0f : 0.0f;
+		float m1 = parameters.type == bandPass ? 1.0f : (parameters.type == highPass ? -damping : 0.0f);
+		float m2 = parameters.type == lowPass ? 1.0f : (parameters.type == highPass ? -1.0f : 0.0f);
+
+		// Unused lanes run on silence and are never written back
+		interleaved.fill(0.0f);
+
+		for (int start = 0; start < numSamples; start += controlInterval)
+		{
+			int length = juce::jmin(controlInterval, numSamples - start);
+
+			for (int lane = 0; lane < numVoices; ++lane)
+				updateCoefficients(voices[static_cast<size_t>(lane)], envelopes[lane][start]);
+
+			Register a1 = gather(coefficients.a1, voices, numVoices);
+			Register a2 = gather(coefficients.a2, voices, numVoices);
+			Register a3 = gather(coefficients.a3, voices, numVoices);
+
+			for (int channel = 0; channel < numChannels; ++channel)
+			{
+				auto c = static_cast<size_t>(channel);
+				float* const* data = channelData.data() + channel * numLanes;
+
+				// Interleaved once per interval, so each sample below is one aligned load and one aligned store
+				for (int lane = 0; lane < numVoices; ++lane)
+				{
+					const float* source = data[lane] + start;
+
+					for (int i = 0; i < length; ++i)
+						interleaved[static_cast<size_t>(i * numLanes + lane)] = source[i];
+				}
+
+				for (int i = 0; i < length; ++i)
+				{
+					float* frame = interleaved.data() + i * numLanes;
+
+					Register v0 = Register::fromRawArray(frame);
+					Register v3 = v0 - ic2[c];
+					Register v1 = a1 * ic1[c] + a2 * v3;
+					Register v2 = ic2[c] + a2 * ic1[c] + a3 * v3;
+					ic1[c] = v1 + v1 - ic1[c];
+					ic2[c] = v2 + v2 - ic2[c];
+
+					Register output = v0 * m0 + v1 * m1 + v2 * m2;
+					output.copyToRawArray(frame);
+				}
+
+				for (int lane = 0; lane < numVoices; ++lane)
+				{
+					float* destination = data[lane] + start;
+
+					for (int i = 0; i < length; ++i)
+						destination[i] = interleaved[static_cast<size_t>(i * numLanes + lane)];
+				}
+			}
+		}
+
+		for (int channel = 0; channel < numChannels; ++channel)
+		{
+			scatter(ic1[static_cast<size_t>(channel)], states[static_cast<size_t>(channel)].ic1, voices, numVoices);
+			scatter(ic2[static_cast<size_t>(channel)], states[static_cast<size_t>(channel)].ic2, voices, numVoices);
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    WavetableBank.h
+    Created: 17 Oct 2026 2:10:41pm
+    Author:  Hallam Saunders
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Read-only lookup tables shared by every voice of every plugin instance.
+// The tables are built once (from prepareToPlay) and only ever read on the audio thread,
+// so selecting a waveform at note-on is just a pointer swap.
+//
+// Each waveform is stored as a mipmap of band-limited tables, one per octave. Level 0 holds
+// maxHarmonics partials and every level above it holds half as many, so the oscillator can
+// always pick a table whose partials stay under Nyquist for the note it is playing.
+class WavetableBank
+{
+public:
+	enum Waveform
+	{
+		sine = 0,
+		square,
+		saw,
+		triangle,
+		noise, // Generated per voice by NoiseGenerator, there is no table for it
+		numWaveforms
+	};
+
+	static constexpr int numTables = noise;
+
+	static constexpr int tableSize = 2048;
+	static constexpr int numLevels = 10;
+	static constexpr int maxHarmonics = tableSize / 4; // Leave headroom so linear interpolation stays clean
+
+	using Table = std::array<float, tableSize + 1>; // Extra guard point so interpolation never wraps
+	using MipMap = std::array<Table, numLevels>;
+
+	// Safe to call from every instance's prepareToPlay, the tables are only filled the first time
+	void prepare()
+	{
+		const juce::ScopedLock sl(buildLock);
+
+		if (built.load())
+			return;
+
+		for (int waveform = 0; waveform < numTables; ++waveform)
+			buildMipMap(waveform);
+
+		built.store(true);
+	}
+
+	bool isPrepared() const
+	{
+		return built.load();
+	}
+
+	const MipMap& getMipMap(int waveform) const
+	{
+		return mipMaps[static_cast<size_t>(juce::jlimit(0, numTables - 1, waveform))];
+	}
+
+	// Fractional mipmap level for a phase increment (frequency / sample rate).
+	// The integer part is the table to read and the fraction is how far to crossfade into the next one.
+	static float getLevelForIncrement(float phaseIncrement)
+	{
+		// Keep the lower table's top partial under 0.3 x sample rate at the start of a crossfade,
+		// so anything folded back while fading out lands above 0.4 x sample rate
+		float level = std::log2(juce::jmax(phaseIncrement, 1.0e-6f) * static_cast<float>(maxHarmonics) / 0.3f);
+		return juce::jlimit(0.0f, static_cast<float>(numLevels - 1), level);
+	}
+
+	static int getNumHarmonics(int level)
+	{
+		return maxHarmonics >> level;
+	}
+
+private:
+	std::array<MipMap, numTables> mipMaps{};
+	std::atomic<bool> built{ false };
+	juce::CriticalSection buildLock;
+
+	void buildMipMap(int waveform)
+	{
+		auto& mipMap = mipMaps[static_cast<size_t>(waveform)];
+
+		// One cycle of sine to sum partials from, sin(2 * pi * h * i / N) is sineCycle[(h * i) % N]
+		std::vector<double> sineCycle(static_cast<size_t>(tableSize));
+		for (int i = 0; i < tableSize; ++i)
+			sineCycle[static_cast<size_t>(i)] = std::sin(juce::MathConstants<double>::twoPi * i / tableSize);
+
+		for (int level = 0; level < numLevels; ++level)
+		{
+			auto& table = mipMap[static_cast<size_t>(level)];
+			int numHarmonics = getNumHarmonics(level);
+
+			for (int i = 0; i < tableSize; ++i)
+			{
+				double sample = 0.0;
+
+				switch (waveform)
+				{
+					case square:
+						for (int h = 1; h <= numHarmonics; h += 2)
+							sample += sineCycle[static_cast<size_t>((h * i) % tableSize)] / h;
+						sample *= 4.0 / juce::MathConstants<double>::pi;
+						break;
+
+					case saw:
+						for (int h = 1; h <= numHarmonics; ++h)
+							sample -= sineCycle[static_cast<size_t>((h * i) % tableSize)] / h;
+						sample *= 2.0 / juce::MathConstants<double>::pi;
+						break;
+
+					case triangle:
+						// Odd cosine partials, starting at -1 to match the naive shape
+						for (int h = 1; h <= numHarmonics; h += 2)
+							sample -= sineCycle[static_cast<size_t>((h * i + tableSize / 4) % tableSize)] / (h * h);
+						sample *= 8.0 / (juce::MathConstants<double>::pi * juce::MathConstants<double>::pi);
+						break;
+
+					default:
+						sample = sineCycle[static_cast<size_t>(i)];
+						break;
+				}
+
+				table[static_cast<size_t>(i)] = static_cast<float>(sample);
+			}
+
+			table[tableSize] = table[0];
+		}
+	}
+};
\ No newline at end of file